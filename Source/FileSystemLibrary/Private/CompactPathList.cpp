@@ -0,0 +1,210 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "CompactPathList.h"
+#include "Misc/Paths.h"
+#include "Algo/Sort.h"
+
+CompactPathList::CompactPathList(const FString& InRootPath)
+	: RootPath(InRootPath)
+{
+	FPaths::NormalizeDirectoryName(RootPath);
+
+	// Node 0 is the root itself
+	Directories.Add(FDirectoryNode{ INDEX_NONE, 0, 0 });
+	DirectoryLookup.Add(FString(), 0);
+}
+
+uint32 CompactPathList::AddName(const TCHAR* Name, uint32& OutLength)
+{
+	FTCHARToUTF8 Converted(Name);
+
+	const uint32 Offset = Names.Num();
+	OutLength = Converted.Length();
+	Names.Append(Converted.Get(), Converted.Length());
+	return Offset;
+}
+
+int32 CompactPathList::FindOrAddDirectory(const FString& RelativePath)
+{
+	// Node 0 is always the root, this also ends the recursion over parents
+	if (RelativePath.IsEmpty())
+	{
+		return 0;
+	}
+
+	// Shrink drops the lookup, rebuild it the first time the list grows again
+	if (DirectoryLookup.Num() == 0)
+	{
+		DirectoryLookup.Reserve(Directories.Num());
+		for (int32 Index = 0; Index < Directories.Num(); Index++)
+		{
+			DirectoryLookup.Add(GetDirectoryPath(Index), Index);
+		}
+	}
+
+	if (const int32* Existing = DirectoryLookup.Find(RelativePath))
+	{
+		return *Existing;
+	}
+
+	int32 Separator = INDEX_NONE;
+	RelativePath.FindLastChar(TEXT('/'), Separator);
+
+	const int32 Parent = FindOrAddDirectory(Separator == INDEX_NONE ? FString() : RelativePath.Left(Separator));
+
+	FDirectoryNode Node;
+	Node.Parent = Parent;
+	Node.NameOffset = AddName(*RelativePath + Separator + 1, Node.NameLength);
+
+	const int32 NodeIndex = Directories.Add(Node);
+	DirectoryLookup.Add(RelativePath, NodeIndex);
+	return NodeIndex;
+}
+
+void CompactPathList::AddFile(const FString& Directory, const TCHAR* Name)
+{
+	// Walks report a whole directory at a time, so this skips the lookup for nearly every file
+	if (LastDirectoryIndex == INDEX_NONE || !Directory.Equals(LastDirectory, ESearchCase::CaseSensitive))
+	{
+		FString RelativePath = Directory.Len() > RootPath.Len() ? Directory.RightChop(RootPath.Len() + 1) : FString();
+		RelativePath.ReplaceInline(TEXT("\\"), TEXT("/"));
+
+		LastDirectoryIndex = FindOrAddDirectory(RelativePath);
+		LastDirectory = Directory;
+	}
+
+	FFileEntry& File = Files.AddDefaulted_GetRef();
+	File.Directory = LastDirectoryIndex;
+	File.NameOffset = AddName(Name, File.NameLength);
+}
+
+void CompactPathList::Append(CompactPathList&& Other)
+{
+	// Directories of Other are matched to ours by relative path, there are far fewer of them than files
+	TArray<int32> DirectoryMapping;
+	DirectoryMapping.SetNumUninitialized(Other.Directories.Num());
+	for (int32 Index = 0; Index < Other.Directories.Num(); Index++)
+	{
+		DirectoryMapping[Index] = FindOrAddDirectory(Other.GetDirectoryPath(Index));
+	}
+
+	const uint32 NameShift = Names.Num();
+	Names.Append(Other.Names);
+
+	Files.Reserve(Files.Num() + Other.Files.Num());
+	for (const FFileEntry& OtherFile : Other.Files)
+	{
+		Files.Add(FFileEntry{ DirectoryMapping[OtherFile.Directory], OtherFile.NameOffset + NameShift, OtherFile.NameLength });
+	}
+
+	LastDirectoryIndex = INDEX_NONE;
+	Other = CompactPathList(Other.RootPath);
+}
+
+void CompactPathList::Sort()
+{
+	// Rank the directories by path once, so comparing two files never rebuilds a path
+	TArray<FString> DirectoryPaths;
+	TArray<int32> DirectoryOrder;
+	DirectoryPaths.SetNum(Directories.Num());
+	DirectoryOrder.SetNumUninitialized(Directories.Num());
+	for (int32 Index = 0; Index < Directories.Num(); Index++)
+	{
+		DirectoryPaths[Index] = GetDirectoryPath(Index);
+		DirectoryOrder[Index] = Index;
+	}
+
+	Algo::Sort(DirectoryOrder, [&DirectoryPaths](int32 A, int32 B)
+	{
+		return DirectoryPaths[A].Compare(DirectoryPaths[B], ESearchCase::CaseSensitive) < 0;
+	});
+
+	TArray<int32> DirectoryRank;
+	DirectoryRank.SetNumUninitialized(Directories.Num());
+	for (int32 Rank = 0; Rank < DirectoryOrder.Num(); Rank++)
+	{
+		DirectoryRank[DirectoryOrder[Rank]] = Rank;
+	}
+
+	// Byte order of UTF-8 names is code point order, no need to decode them
+	Algo::Sort(Files, [this, &DirectoryRank](const FFileEntry& A, const FFileEntry& B)
+	{
+		if (A.Directory != B.Directory)
+		{
+			return DirectoryRank[A.Directory] < DirectoryRank[B.Directory];
+		}
+
+		const int32 Compared = FMemory::Memcmp(Names.GetData() + A.NameOffset, Names.GetData() + B.NameOffset, FMath::Min(A.NameLength, B.NameLength));
+		return Compared != 0 ? Compared < 0 : A.NameLength < B.NameLength;
+	});
+}
+
+void CompactPathList::Shrink()
+{
+	DirectoryLookup.Empty();
+	LastDirectory.Empty();
+	LastDirectoryIndex = INDEX_NONE;
+
+	Directories.Shrink();
+	Files.Shrink();
+	Names.Shrink();
+}
+
+FString CompactPathList::GetDirectoryPath(int32 DirectoryIndex) const
+{
+	// Collect the segments leaf first, then join them root first
+	TArray<int32, TInlineAllocator<32>> Segments;
+	for (int32 Node = DirectoryIndex; Node > 0; Node = Directories[Node].Parent)
+	{
+		Segments.Add(Node);
+	}
+
+	FString Path;
+	for (int32 Index = Segments.Num() - 1; Index >= 0; Index--)
+	{
+		const FDirectoryNode& Node = Directories[Segments[Index]];
+		FUTF8ToTCHAR Converted(Names.GetData() + Node.NameOffset, Node.NameLength);
+		if (!Path.IsEmpty())
+		{
+			Path.AppendChar(TEXT('/'));
+		}
+		Path.AppendChars(Converted.Get(), Converted.Length());
+	}
+	return Path;
+}
+
+FString CompactPathList::GetFileName(int32 Index) const
+{
+	const FFileEntry& File = Files[Index];
+	FUTF8ToTCHAR Converted(Names.GetData() + File.NameOffset, File.NameLength);
+	return FString(Converted.Length(), Converted.Get());
+}
+
+FString CompactPathList::GetPath(int32 Index) const
+{
+	const FString RelativeDirectory = GetDirectoryPath(Files[Index].Directory);
+	return RelativeDirectory.IsEmpty() ? RootPath / GetFileName(Index) : RootPath / RelativeDirectory / GetFileName(Index);
+}
+
+void CompactPathList::ToArray(TArray<FString>& OutPaths) const
+{
+	// Each directory path is rebuilt once, not once per file
+	TArray<FString> DirectoryPaths;
+	DirectoryPaths.SetNum(Directories.Num());
+	for (int32 Index = 0; Index < Directories.Num(); Index++)
+	{
+		const FString RelativeDirectory = GetDirectoryPath(Index);
+		DirectoryPaths[Index] = RelativeDirectory.IsEmpty() ? RootPath : RootPath / RelativeDirectory;
+	}
+
+	OutPaths.Reserve(OutPaths.Num() + Files.Num());
+	for (int32 Index = 0; Index < Files.Num(); Index++)
+	{
+		OutPaths.Add(DirectoryPaths[Files[Index].Directory] / GetFileName(Index));
+	}
+}
+
+SIZE_T CompactPathList::GetAllocatedSize() const
+{
+	return Directories.GetAllocatedSize() + Files.GetAllocatedSize() + Names.GetAllocatedSize() + DirectoryLookup.GetAllocatedSize();
+}
@@ -0,0 +1,379 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "ContentSearchManager.h"
+#include "DirectoryWalkManager.h"
+#include "FileFilter.h"
+#include "ParallelFileWork.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Async/MappedFileHandle.h"
+#include "Internationalization/Regex.h"
+#include "Templates/UniquePtr.h"
+#include <string.h>
+
+namespace
+{
+	const int64 BinaryProbeSize = 8 * 1024;
+
+	uint8 FoldCase(uint8 Byte)
+	{
+		return (Byte >= 'A' && Byte <= 'Z') ? Byte + ('a' - 'A') : Byte;
+	}
+
+	/** Literal byte pattern, compiled once per search. */
+	class FLiteralMatcher
+	{
+
+	public:
+		FLiteralMatcher(const FString& Pattern, bool bInCaseSensitive)
+			: bCaseSensitive(bInCaseSensitive)
+		{
+			FTCHARToUTF8 Converted(*Pattern);
+			Needle.Append((const uint8*)Converted.Get(), Converted.Length());
+
+			// Case folding is ASCII only, multi-byte UTF-8 sequences are compared as they are
+			if (!bCaseSensitive)
+			{
+				for (uint8& Byte : Needle)
+				{
+					Byte = FoldCase(Byte);
+				}
+			}
+
+			// Horspool skip table, how far the window can move when its last byte is B
+			for (int32 Byte = 0; Byte < 256; Byte++)
+			{
+				Skip[Byte] = Needle.Num();
+			}
+			for (int32 Index = 0; Index + 1 < Needle.Num(); Index++)
+			{
+				Skip[Needle[Index]] = Needle.Num() - 1 - Index;
+				if (!bCaseSensitive && Needle[Index] >= 'a' && Needle[Index] <= 'z')
+				{
+					Skip[Needle[Index] - ('a' - 'A')] = Needle.Num() - 1 - Index;
+				}
+			}
+		}
+
+		/** Returns the offset of the first match at or after Start, or -1. */
+		int64 Find(const uint8* Data, int64 Size, int64 Start) const
+		{
+			const int64 NeedleLength = Needle.Num();
+			if (NeedleLength == 0 || Size - Start < NeedleLength)
+			{
+				return -1;
+			}
+
+			// Short case-sensitive needles: let the vectorized memchr find the first byte, then compare the rest
+			if (bCaseSensitive && NeedleLength <= 3)
+			{
+				for (int64 Offset = Start; Offset <= Size - NeedleLength;)
+				{
+					const uint8* Found = (const uint8*)memchr(Data + Offset, Needle[0], Size - NeedleLength + 1 - Offset);
+					if (!Found)
+					{
+						return -1;
+					}
+					Offset = Found - Data;
+					if (FMemory::Memcmp(Found, Needle.GetData(), NeedleLength) == 0)
+					{
+						return Offset;
+					}
+					Offset++;
+				}
+				return -1;
+			}
+
+			for (int64 Offset = Start; Offset <= Size - NeedleLength;)
+			{
+				const uint8 Last = Data[Offset + NeedleLength - 1];
+				if ((bCaseSensitive ? Last : FoldCase(Last)) == Needle[NeedleLength - 1] && Matches(Data + Offset))
+				{
+					return Offset;
+				}
+				Offset += Skip[Last];
+			}
+			return -1;
+		}
+
+	private:
+		bool Matches(const uint8* Window) const
+		{
+			if (bCaseSensitive)
+			{
+				return FMemory::Memcmp(Window, Needle.GetData(), Needle.Num()) == 0;
+			}
+
+			for (int32 Index = 0; Index < Needle.Num(); Index++)
+			{
+				if (FoldCase(Window[Index]) != Needle[Index])
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		TArray<uint8> Needle;
+		int32 Skip[256];
+		bool bCaseSensitive;
+	};
+
+	FString MakeLineText(const uint8* LineStart, int64 LineLength, int32 MaxLength)
+	{
+		while (LineLength > 0 && (LineStart[LineLength - 1] == '\r' || LineStart[LineLength - 1] == '\n'))
+		{
+			LineLength--;
+		}
+		LineLength = FMath::Min<int64>(LineLength, MaxLength);
+
+		FUTF8ToTCHAR Converted((const ANSICHAR*)LineStart, LineLength);
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	bool SearchLiteral(const FString& Path, const uint8* Data, int64 Size, const FLiteralMatcher& Matcher, const FContentSearchOptions& Options, TArray<FContentSearchMatch>& OutMatches)
+	{
+		// Line numbers are tracked incrementally, only the bytes between two matches are scanned for newlines
+		int32 Line = 1;
+		int64 LineStart = 0;
+		int64 Counted = 0;
+
+		for (int64 Offset = Matcher.Find(Data, Size, 0); Offset >= 0; Offset = Matcher.Find(Data, Size, Offset + 1))
+		{
+			while (const uint8* NewLine = (const uint8*)memchr(Data + Counted, '\n', Offset - Counted))
+			{
+				Line++;
+				Counted = NewLine - Data + 1;
+				LineStart = Counted;
+			}
+			Counted = Offset;
+
+			const uint8* LineEnd = (const uint8*)memchr(Data + Offset, '\n', Size - Offset);
+			const int64 LineLength = (LineEnd ? LineEnd - Data : Size) - LineStart;
+
+			FContentSearchMatch& Match = OutMatches.AddDefaulted_GetRef();
+			Match.Path = Path;
+			Match.Line = Line;
+			Match.Column = int32(Offset - LineStart + 1);
+			Match.LineText = MakeLineText(Data + LineStart, LineLength, Options.MaxLineTextLength);
+
+			if (Options.MaxMatchesPerFile > 0 && OutMatches.Num() >= Options.MaxMatchesPerFile)
+			{
+				break;
+			}
+		}
+		return true;
+	}
+
+	/** Whether the groups of Pattern are closed in order, skipping escaped characters, \Q...\E quotes and character classes. */
+	bool HasBalancedGroups(const FString& Pattern)
+	{
+		int32 Depth = 0;
+		for (int32 Index = 0; Index < Pattern.Len(); Index++)
+		{
+			const TCHAR Char = Pattern[Index];
+			if (Char == TEXT('\\'))
+			{
+				if (Index + 1 < Pattern.Len() && Pattern[Index + 1] == TEXT('Q'))
+				{
+					const int32 QuoteEnd = Pattern.Find(TEXT("\\E"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Index + 2);
+					Index = QuoteEnd == INDEX_NONE ? Pattern.Len() : QuoteEnd + 1;
+				}
+				else
+				{
+					Index++;
+				}
+			}
+			else if (Char == TEXT('['))
+			{
+				// A ] right after [ or [^ is a literal member of the class
+				Index++;
+				if (Index < Pattern.Len() && Pattern[Index] == TEXT('^'))
+				{
+					Index++;
+				}
+				if (Index < Pattern.Len() && Pattern[Index] == TEXT(']'))
+				{
+					Index++;
+				}
+				while (Index < Pattern.Len() && Pattern[Index] != TEXT(']'))
+				{
+					Index += Pattern[Index] == TEXT('\\') ? 2 : 1;
+				}
+				if (Index >= Pattern.Len())
+				{
+					return false;
+				}
+			}
+			else if (Char == TEXT('('))
+			{
+				Depth++;
+			}
+			else if (Char == TEXT(')') && --Depth < 0)
+			{
+				return false;
+			}
+		}
+		return Depth == 0;
+	}
+
+	/** Compiles Pattern, null if it isn't a valid regular expression. The compiled pattern is shared by every worker. */
+	TUniquePtr<FRegexPattern> CompileRegex(const FString& Pattern, bool bCaseSensitive)
+	{
+		// The probe below wraps the pattern in a group, which stray parentheses can turn valid: a)( becomes (?:a)()|
+		if (!HasBalancedGroups(Pattern))
+		{
+			return nullptr;
+		}
+
+		const FString Source = bCaseSensitive ? Pattern : TEXT("(?i)") + Pattern;
+
+		// FRegexPattern doesn't report compile errors and an invalid pattern just never matches. Wrapped in an alternation
+		// with the empty string, any valid pattern matches an empty text, so a probe that finds nothing means it didn't compile.
+		const FRegexPattern Probe(TEXT("(?:") + Source + TEXT(")|"));
+		FRegexMatcher ProbeMatcher(Probe, FString());
+		if (!ProbeMatcher.FindNext())
+		{
+			return nullptr;
+		}
+
+		return MakeUnique<FRegexPattern>(Source);
+	}
+
+	bool SearchRegex(const FString& Path, const uint8* Data, int64 Size, const FRegexPattern& RegexPattern, const FContentSearchOptions& Options, TArray<FContentSearchMatch>& OutMatches)
+	{
+		// The regex engine needs TCHARs, so this mode decodes the file
+		FUTF8ToTCHAR Converted((const ANSICHAR*)Data, (int32)FMath::Min<int64>(Size, MAX_int32));
+		const FString Text(Converted.Length(), Converted.Get());
+
+		FRegexMatcher Matcher(RegexPattern, Text);
+
+		int32 Line = 1;
+		int32 LineStart = 0;
+		int32 Counted = 0;
+
+		while (Matcher.FindNext())
+		{
+			const int32 Offset = Matcher.GetMatchBeginning();
+			for (; Counted < Offset; Counted++)
+			{
+				if (Text[Counted] == TEXT('\n'))
+				{
+					Line++;
+					LineStart = Counted + 1;
+				}
+			}
+
+			int32 LineEnd = Offset;
+			while (LineEnd < Text.Len() && Text[LineEnd] != TEXT('\n') && LineEnd - LineStart < Options.MaxLineTextLength)
+			{
+				LineEnd++;
+			}
+
+			FContentSearchMatch& Match = OutMatches.AddDefaulted_GetRef();
+			Match.Path = Path;
+			Match.Line = Line;
+			Match.Column = Offset - LineStart + 1;
+			Match.LineText = Text.Mid(LineStart, LineEnd - LineStart);
+			Match.LineText.RemoveFromEnd(TEXT("\r"));
+
+			if (Options.MaxMatchesPerFile > 0 && OutMatches.Num() >= Options.MaxMatchesPerFile)
+			{
+				break;
+			}
+
+			// Empty matches would find the same spot forever
+			if (Matcher.GetMatchEnding() == Offset)
+			{
+				Matcher.SetLimits(Offset + 1, Text.Len());
+			}
+		}
+		return true;
+	}
+
+	/** Searches with LiteralMatcher when set, with RegexPattern otherwise. */
+	bool SearchMappedFile(const FString& Path, const FLiteralMatcher* LiteralMatcher, const FRegexPattern* RegexPattern, const FContentSearchOptions& Options, TArray<FContentSearchMatch>& OutMatches)
+	{
+		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+		TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*Path));
+		if (!MappedFile || MappedFile->GetFileSize() <= 0)
+		{
+			return false;
+		}
+
+		TUniquePtr<IMappedFileRegion> Region(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+		if (!Region)
+		{
+			return false;
+		}
+
+		const uint8* Data = Region->GetMappedPtr();
+		const int64 Size = Region->GetMappedSize();
+
+		if (memchr(Data, 0, FMath::Min(Size, BinaryProbeSize)))
+		{
+			return false;
+		}
+
+		return LiteralMatcher ? SearchLiteral(Path, Data, Size, *LiteralMatcher, Options, OutMatches) : SearchRegex(Path, Data, Size, *RegexPattern, Options, OutMatches);
+	}
+}
+
+bool ContentSearchManager::SearchFile(const FString& PathToFile, const FString& Pattern, const FContentSearchOptions& Options, TArray<FContentSearchMatch>& OutMatches)
+{
+	if (Options.bRegex)
+	{
+		const TUniquePtr<FRegexPattern> RegexPattern = CompileRegex(Pattern, Options.bCaseSensitive);
+		return RegexPattern.IsValid() && SearchMappedFile(PathToFile, nullptr, RegexPattern.Get(), Options, OutMatches);
+	}
+
+	const FLiteralMatcher Matcher(Pattern, Options.bCaseSensitive);
+	return SearchMappedFile(PathToFile, &Matcher, nullptr, Options, OutMatches);
+}
+
+bool ContentSearchManager::Search(const FString& PathToDirectory, const FileFilter& Filter, const FString& Pattern, const FContentSearchOptions& Options, int32 MaxConcurrency, const FThreadSafeBool* CancelFlag, const FMatchesCallback& OnMatches)
+{
+	if (Pattern.IsEmpty())
+	{
+		return false;
+	}
+
+	// Compiled once for all files, before anything is walked so an invalid pattern fails right away
+	TUniquePtr<FLiteralMatcher> LiteralMatcher;
+	TUniquePtr<FRegexPattern> RegexPattern;
+	if (Options.bRegex)
+	{
+		RegexPattern = CompileRegex(Pattern, Options.bCaseSensitive);
+		if (!RegexPattern.IsValid())
+		{
+			return false;
+		}
+	}
+	else
+	{
+		LiteralMatcher = MakeUnique<FLiteralMatcher>(Pattern, Options.bCaseSensitive);
+	}
+
+	TArray<FString> Files;
+	if (!DirectoryWalkManager::Get().FindFiles(Files, PathToDirectory, Filter, true, MaxConcurrency))
+	{
+		return false;
+	}
+
+	ParallelFileWork::ForEach(Files.Num(), MaxConcurrency, [&](int32 Index)
+	{
+		if (CancelFlag && *CancelFlag)
+		{
+			return;
+		}
+
+		TArray<FContentSearchMatch> Matches;
+		if (SearchMappedFile(Files[Index], LiteralMatcher.Get(), RegexPattern.Get(), Options, Matches) && Matches.Num() > 0 && OnMatches)
+		{
+			OnMatches(MoveTemp(Matches));
+		}
+	});
+
+	return true;
+}
@@ -0,0 +1,68 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "DirectoryEnumerator.h"
+#include "DirectoryWalkManager.h"
+#include "Misc/Paths.h"
+
+DirectoryEnumerator::DirectoryEnumerator(const FString& PathToDirectory, const FString& ExtensionFilter, bool bInRecursive, int32 InBatchSize, bool bInOnlyFilenames)
+	: bRecursive(bInRecursive)
+	, bOnlyFilenames(bInOnlyFilenames)
+	, BatchSize(FMath::Max(InBatchSize, 1))
+{
+	Extension = DirectoryWalkManager::NormalizeExtensionFilter(ExtensionFilter);
+	PendingDirectories.Add(PathToDirectory);
+}
+
+bool DirectoryEnumerator::ListNextDirectory()
+{
+	if (PendingDirectories.Num() == 0)
+	{
+		return false;
+	}
+
+	const FString Directory = PendingDirectories.Pop(EAllowShrinking::No);
+
+	PendingFiles.Reset();
+	NextPendingFile = 0;
+
+	DirectoryWalkManager::Get().ReadDirectory(Directory, [this, &Directory](const TCHAR* Name, bool bIsDirectory)
+	{
+		if (bIsDirectory)
+		{
+			if (bRecursive)
+			{
+				PendingDirectories.Add(Directory / Name);
+			}
+		}
+		else
+		{
+			FString File = Directory / Name;
+			if (Extension.IsEmpty() || File.EndsWith(Extension))
+			{
+				PendingFiles.Add(bOnlyFilenames ? FPaths::GetBaseFilename(File) : MoveTemp(File));
+			}
+		}
+	});
+
+	return true;
+}
+
+bool DirectoryEnumerator::NextBatch(TArray<FString>& OutBatch)
+{
+	OutBatch.Reset();
+
+	while (OutBatch.Num() < BatchSize)
+	{
+		if (NextPendingFile >= PendingFiles.Num() && !ListNextDirectory())
+		{
+			break;
+		}
+
+		while (NextPendingFile < PendingFiles.Num() && OutBatch.Num() < BatchSize)
+		{
+			OutBatch.Add(MoveTemp(PendingFiles[NextPendingFile++]));
+		}
+	}
+
+	return OutBatch.Num() > 0;
+}
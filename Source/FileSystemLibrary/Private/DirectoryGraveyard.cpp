@@ -0,0 +1,245 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "DirectoryGraveyard.h"
+#include "FileCopyManager.h"
+#include "ParallelFileWork.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/ThreadSafeBool.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Containers/Queue.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	const TCHAR* GraveyardDirectoryName = TEXT(".FileSystemLibraryGraveyard");
+
+	/** Every graveyard root ever used, so leftovers can be found again after a restart. */
+	FString GetRegistryPath()
+	{
+		return FPaths::ProjectSavedDir() / TEXT("FileSystemLibrary") / TEXT("Graveyards.txt");
+	}
+
+	// Held while a graveyard directory is created and moved into, and while the purger removes an empty graveyard,
+	// so a burial never finds its graveyard deleted between the two steps
+	FCriticalSection GraveyardDirectoryLock;
+
+	/** Deletes queued graveyard entries one after the other on a low priority thread. */
+	class FGraveyardPurger : public FRunnable
+	{
+	public:
+		FGraveyardPurger()
+		{
+			WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+			Thread = FRunnableThread::Create(this, TEXT("FileSystemLibraryGraveyard"), 0, TPri_Lowest);
+		}
+
+		virtual ~FGraveyardPurger()
+		{
+			Stop();
+			if (Thread)
+			{
+				Thread->WaitForCompletion();
+				delete Thread;
+			}
+			FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+		}
+
+		void Enqueue(const FString& BuriedDirectory)
+		{
+			Pending.Enqueue(BuriedDirectory);
+			WorkEvent->Trigger();
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopping)
+			{
+				FString BuriedDirectory;
+				if (Pending.Dequeue(BuriedDirectory))
+				{
+					Purge(BuriedDirectory);
+				}
+				else
+				{
+					WorkEvent->Wait();
+				}
+			}
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopping = true;
+			WorkEvent->Trigger();
+		}
+
+	private:
+		void Purge(const FString& BuriedDirectory)
+		{
+			IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+			// Top level entries are independent subtrees, delete them in parallel
+			TArray<FString> Entries;
+			TArray<bool> EntryIsDirectory;
+			PlatformFile.IterateDirectory(*BuriedDirectory, [&Entries, &EntryIsDirectory](const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+			{
+				Entries.Add(FilenameOrDirectory);
+				EntryIsDirectory.Add(bIsDirectory);
+				return true;
+			});
+
+			ParallelFileWork::ForEach(Entries.Num(), 0, [this, &PlatformFile, &Entries, &EntryIsDirectory](int32 Index)
+			{
+				if (bStopping)
+				{
+					return;
+				}
+
+				if (EntryIsDirectory[Index])
+				{
+					PlatformFile.DeleteDirectoryRecursively(*Entries[Index]);
+				}
+				else
+				{
+					PlatformFile.SetReadOnly(*Entries[Index], false);
+					PlatformFile.DeleteFile(*Entries[Index]);
+				}
+			}, true);
+
+			if (!bStopping)
+			{
+				PlatformFile.DeleteDirectoryRecursively(*BuriedDirectory);
+
+				// Only succeeds once the graveyard is empty
+				FScopeLock Lock(&GraveyardDirectoryLock);
+				PlatformFile.DeleteDirectory(*FPaths::GetPath(BuriedDirectory));
+			}
+		}
+
+		TQueue<FString, EQueueMode::Mpsc> Pending;
+		FEvent* WorkEvent = nullptr;
+		FRunnableThread* Thread = nullptr;
+		FThreadSafeBool bStopping;
+	};
+
+	FCriticalSection GraveyardLock;
+	TUniquePtr<FGraveyardPurger> Purger;
+	TSet<FString> RegisteredGraveyards;
+	bool bRegistryLoaded = false;
+
+	// Both need GraveyardLock
+	void LoadRegistry()
+	{
+		if (!bRegistryLoaded)
+		{
+			TArray<FString> Lines;
+			FFileHelper::LoadFileToStringArray(Lines, *GetRegistryPath());
+			RegisteredGraveyards.Append(Lines);
+			bRegistryLoaded = true;
+		}
+	}
+
+	void SaveRegistry()
+	{
+		FFileHelper::SaveStringArrayToFile(RegisteredGraveyards.Array(), *GetRegistryPath());
+	}
+
+	void EnqueueLocked(const FString& BuriedDirectory)
+	{
+		if (!Purger)
+		{
+			Purger = MakeUnique<FGraveyardPurger>();
+		}
+		Purger->Enqueue(BuriedDirectory);
+	}
+}
+
+bool DirectoryGraveyard::Bury(const FString& PathToDirectory)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!PlatformFile.DirectoryExists(*PathToDirectory))
+	{
+		return false;
+	}
+
+	// Prefer the project's Saved directory so the graveyard doesn't show up in listings of the parent
+	const FString FullPath = FPaths::ConvertRelativePathToFull(PathToDirectory);
+	FString Graveyard = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir()) / TEXT("FileSystemLibrary") / GraveyardDirectoryName;
+
+	if (!FileCopyManager::Get().IsSameVolume(FullPath, Graveyard))
+	{
+		FString ParentPath = FullPath;
+		FPaths::NormalizeDirectoryName(ParentPath);
+		Graveyard = FPaths::GetPath(ParentPath) / GraveyardDirectoryName;
+	}
+
+	const FString BuriedDirectory = Graveyard / FGuid::NewGuid().ToString();
+
+	bool bBuried;
+	{
+		FScopeLock Lock(&GraveyardDirectoryLock);
+
+		bBuried = PlatformFile.CreateDirectoryTree(*Graveyard) && PlatformFile.MoveFile(*BuriedDirectory, *FullPath);
+		if (!bBuried)
+		{
+			PlatformFile.DeleteDirectory(*Graveyard);
+		}
+	}
+
+	if (!bBuried)
+	{
+		return PlatformFile.DeleteDirectoryRecursively(*PathToDirectory);
+	}
+
+	FScopeLock Lock(&GraveyardLock);
+
+	LoadRegistry();
+	if (!RegisteredGraveyards.Contains(Graveyard))
+	{
+		RegisteredGraveyards.Add(Graveyard);
+		SaveRegistry();
+	}
+
+	EnqueueLocked(BuriedDirectory);
+	return true;
+}
+
+void DirectoryGraveyard::PurgeLeftovers()
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	FScopeLock Lock(&GraveyardLock);
+
+	LoadRegistry();
+
+	// Forget graveyards that were fully purged
+	for (auto It = RegisteredGraveyards.CreateIterator(); It; ++It)
+	{
+		if (!PlatformFile.DirectoryExists(**It))
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		PlatformFile.IterateDirectory(**It, [](const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+		{
+			EnqueueLocked(FilenameOrDirectory);
+			return true;
+		});
+	}
+
+	SaveRegistry();
+}
+
+void DirectoryGraveyard::Shutdown()
+{
+	FScopeLock Lock(&GraveyardLock);
+	Purger.Reset();
+}
@@ -0,0 +1,50 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "DirectoryListing.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/Paths.h"
+
+TSharedRef<DirectoryListing, ESPMode::ThreadSafe> DirectoryListing::Create(const FString& PathToDirectory, bool bRecursive)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TSharedRef<DirectoryListing, ESPMode::ThreadSafe> Listing = MakeShared<DirectoryListing, ESPMode::ThreadSafe>();
+	Listing->RootPath = PathToDirectory;
+	FPaths::NormalizeDirectoryName(Listing->RootPath);
+	Listing->NameOffsets.Add(0);
+
+	const int32 RootLength = Listing->RootPath.Len();
+	DirectoryListing& Entries = Listing.Get();
+
+	auto Visitor = [&Entries, RootLength](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+	{
+		// Strip the listed directory and the separator after it
+		const TCHAR* RelativePath = FilenameOrDirectory + RootLength;
+		while (*RelativePath == TEXT('/') || *RelativePath == TEXT('\\'))
+		{
+			RelativePath++;
+		}
+
+		Entries.Names.Append(RelativePath, FCString::Strlen(RelativePath));
+		Entries.NameOffsets.Add(Entries.Names.Num());
+
+		Entries.Sizes.Add(StatData.FileSize);
+		Entries.CreationTimes.Add(StatData.CreationTime);
+		Entries.AccessTimes.Add(StatData.AccessTime);
+		Entries.ModificationTimes.Add(StatData.ModificationTime);
+		Entries.Flags.Add((StatData.bIsDirectory ? Directory : 0) | (StatData.bIsReadOnly ? ReadOnly : 0));
+		return true;
+	};
+
+	if (bRecursive)
+	{
+		PlatformFile.IterateDirectoryStatRecursively(*Listing->RootPath, Visitor);
+	}
+	else
+	{
+		PlatformFile.IterateDirectoryStat(*Listing->RootPath, Visitor);
+	}
+
+	return Listing;
+}
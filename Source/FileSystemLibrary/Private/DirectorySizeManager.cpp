@@ -0,0 +1,176 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "DirectorySizeManager.h"
+#include "ParallelFileWork.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
+#include <atomic>
+
+namespace
+{
+	// Same cap as the stat cache, the cache is emptied when it is reached
+	const int32 MaxCachedDirectories = 256 * 1024;
+
+	/** What a single directory directly contains, valid while its modification time is ModificationTicks. */
+	struct FDirectoryContent
+	{
+		int64 ModificationTicks = 0;
+		int64 FileBytes = 0;
+		int64 NumFiles = 0;
+		TArray<FString> SubDirectories;
+	};
+
+	FRWLock CacheLock;
+	TMap<FString, FDirectoryContent> Cache;
+
+	/** Lists Directory, or takes its content from the cache when its modification time didn't change. */
+	bool GetDirectoryContent(const FString& Directory, bool bUseCache, FDirectoryContent& OutContent)
+	{
+		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+		const FFileStatData DirectoryStat = PlatformFile.GetStatData(*Directory);
+		if (!DirectoryStat.bIsValid || !DirectoryStat.bIsDirectory)
+		{
+			return false;
+		}
+		const int64 ModificationTicks = DirectoryStat.ModificationTime.GetTicks();
+
+		if (bUseCache)
+		{
+			FReadScopeLock Lock(CacheLock);
+			const FDirectoryContent* Cached = Cache.Find(Directory);
+			if (Cached && Cached->ModificationTicks == ModificationTicks)
+			{
+				OutContent = *Cached;
+				return true;
+			}
+		}
+
+		OutContent = FDirectoryContent();
+		OutContent.ModificationTicks = ModificationTicks;
+
+		PlatformFile.IterateDirectoryStat(*Directory, [&OutContent](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+		{
+			if (StatData.bIsDirectory)
+			{
+				OutContent.SubDirectories.Add(FPaths::GetCleanFilename(FilenameOrDirectory));
+			}
+			else
+			{
+				OutContent.FileBytes += FMath::Max<int64>(StatData.FileSize, 0);
+				OutContent.NumFiles++;
+			}
+			return true;
+		});
+
+		if (bUseCache)
+		{
+			FWriteScopeLock Lock(CacheLock);
+			if (Cache.Num() >= MaxCachedDirectories)
+			{
+				Cache.Reset();
+			}
+			Cache.Add(Directory, OutContent);
+		}
+
+		return true;
+	}
+}
+
+bool DirectorySizeManager::ComputeSize(const FString& PathToDirectory, int32 MaxConcurrency, bool bUseCache, FDirectorySizeStats& OutTotal, TArray<FDirectorySizeStats>* OutSubDirectories)
+{
+	FString Root = PathToDirectory;
+	FPaths::NormalizeDirectoryName(Root);
+
+	FDirectoryContent RootContent;
+	if (!GetDirectoryContent(Root, bUseCache, RootContent))
+	{
+		return false;
+	}
+
+	// One running total per direct sub-directory, every directory below it adds into the same one
+	const int32 NumSubDirectories = RootContent.SubDirectories.Num();
+	TUniquePtr<std::atomic<int64>[]> SubDirectoryBytes(new std::atomic<int64>[NumSubDirectories]);
+	TUniquePtr<std::atomic<int64>[]> SubDirectoryFiles(new std::atomic<int64>[NumSubDirectories]);
+	for (int32 Index = 0; Index < NumSubDirectories; Index++)
+	{
+		SubDirectoryBytes[Index] = 0;
+		SubDirectoryFiles[Index] = 0;
+	}
+
+	FileTaskScheduler Scheduler(MaxConcurrency);
+
+	TFunction<void(const FString&, int32, FileTaskScheduler&, int32)> SizeOneDirectory;
+	SizeOneDirectory = [bUseCache, &SubDirectoryBytes, &SubDirectoryFiles, &SizeOneDirectory](const FString& Directory, int32 Bucket, FileTaskScheduler& InScheduler, int32 WorkerIndex)
+	{
+		FDirectoryContent Content;
+		if (!GetDirectoryContent(Directory, bUseCache, Content))
+		{
+			return;
+		}
+
+		SubDirectoryBytes[Bucket] += Content.FileBytes;
+		SubDirectoryFiles[Bucket] += Content.NumFiles;
+
+		for (const FString& SubDirectory : Content.SubDirectories)
+		{
+			const FString SubDirectoryPath = Directory / SubDirectory;
+			InScheduler.Spawn(WorkerIndex, [SubDirectoryPath, Bucket, &SizeOneDirectory](FileTaskScheduler& TaskScheduler, int32 TaskWorkerIndex)
+			{
+				SizeOneDirectory(SubDirectoryPath, Bucket, TaskScheduler, TaskWorkerIndex);
+			});
+		}
+	};
+
+	for (int32 Index = 0; Index < NumSubDirectories; Index++)
+	{
+		const FString SubDirectoryPath = Root / RootContent.SubDirectories[Index];
+		Scheduler.Spawn(0, [SubDirectoryPath, Index, &SizeOneDirectory](FileTaskScheduler& TaskScheduler, int32 TaskWorkerIndex)
+		{
+			SizeOneDirectory(SubDirectoryPath, Index, TaskScheduler, TaskWorkerIndex);
+		});
+	}
+	Scheduler.Run();
+
+	OutTotal = FDirectorySizeStats();
+	OutTotal.Path = Root;
+	OutTotal.SizeBytes = RootContent.FileBytes;
+	OutTotal.NumFiles = RootContent.NumFiles;
+
+	if (OutSubDirectories)
+	{
+		OutSubDirectories->Reset(NumSubDirectories);
+	}
+
+	for (int32 Index = 0; Index < NumSubDirectories; Index++)
+	{
+		OutTotal.SizeBytes += SubDirectoryBytes[Index];
+		OutTotal.NumFiles += SubDirectoryFiles[Index];
+
+		if (OutSubDirectories)
+		{
+			FDirectorySizeStats& SubDirectory = OutSubDirectories->AddDefaulted_GetRef();
+			SubDirectory.Path = Root / RootContent.SubDirectories[Index];
+			SubDirectory.SizeBytes = SubDirectoryBytes[Index];
+			SubDirectory.NumFiles = SubDirectoryFiles[Index];
+		}
+	}
+
+	if (OutSubDirectories)
+	{
+		OutSubDirectories->Sort([](const FDirectorySizeStats& A, const FDirectorySizeStats& B)
+		{
+			return A.SizeBytes > B.SizeBytes;
+		});
+	}
+
+	return true;
+}
+
+void DirectorySizeManager::ClearCache()
+{
+	FWriteScopeLock Lock(CacheLock);
+	Cache.Empty();
+}
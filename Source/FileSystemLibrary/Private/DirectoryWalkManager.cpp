@@ -0,0 +1,215 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "DirectoryWalkManager.h"
+#include "CompactPathList.h"
+#include "FileFilter.h"
+#include "ParallelFileWork.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/Paths.h"
+#include "Algo/Sort.h"
+
+#if PLATFORM_LINUX
+#include "Linux/DirectoryWalkManagerLinux.h"
+#endif
+
+DirectoryWalkManager::DirectoryWalkManager()
+{
+}
+
+DirectoryWalkManager::~DirectoryWalkManager()
+{
+}
+
+bool DirectoryWalkManager::ReadDirectory(const FString& PathToDirectory, FEntryVisitor Visitor)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	return PlatformFile.IterateDirectory(*PathToDirectory, [&Visitor](const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+	{
+		// Point at the name inside the path rather than allocating a clean filename
+		const TCHAR* Name = FilenameOrDirectory;
+		for (const TCHAR* Char = FilenameOrDirectory; *Char; Char++)
+		{
+			if (*Char == TEXT('/') || *Char == TEXT('\\'))
+			{
+				Name = Char + 1;
+			}
+		}
+
+		Visitor(Name, bIsDirectory);
+		return true;
+	});
+}
+
+bool DirectoryWalkManager::Walk(const FString& PathToDirectory, bool bRecursive, int32 MaxConcurrency, FWalkVisitor Visitor)
+{
+	FString Root = PathToDirectory;
+	FPaths::NormalizeDirectoryName(Root);
+
+	if (!bRecursive)
+	{
+		return ReadDirectory(Root, [&Visitor, &Root](const TCHAR* Name, bool bIsDirectory)
+		{
+			Visitor(0, Root, Name, bIsDirectory);
+		});
+	}
+
+	FileTaskScheduler Scheduler(GetNumWorkers(MaxConcurrency));
+	bool bRootRead = false;
+
+	TFunction<bool(const FString&, FileTaskScheduler&, int32)> WalkOneDirectory;
+	WalkOneDirectory = [this, &Visitor, &WalkOneDirectory](const FString& Directory, FileTaskScheduler& InScheduler, int32 WorkerIndex)
+	{
+		return ReadDirectory(Directory, [&](const TCHAR* Name, bool bIsDirectory)
+		{
+			if (Visitor(WorkerIndex, Directory, Name, bIsDirectory) && bIsDirectory)
+			{
+				const FString SubDirectory = Directory / Name;
+				InScheduler.Spawn(WorkerIndex, [SubDirectory, &WalkOneDirectory](FileTaskScheduler& TaskScheduler, int32 TaskWorkerIndex)
+				{
+					WalkOneDirectory(SubDirectory, TaskScheduler, TaskWorkerIndex);
+				});
+			}
+		});
+	};
+
+	Scheduler.Spawn(0, [&Root, &bRootRead, &WalkOneDirectory](FileTaskScheduler& TaskScheduler, int32 TaskWorkerIndex)
+	{
+		bRootRead = WalkOneDirectory(Root, TaskScheduler, TaskWorkerIndex);
+	});
+	Scheduler.Run();
+
+	return bRootRead;
+}
+
+bool DirectoryWalkManager::FindFiles(TArray<FString>& OutFiles, const FString& PathToDirectory, const FString& ExtensionFilter, bool bRecursive, int32 MaxConcurrency)
+{
+	FFileFilterRules Rules;
+
+	const FString Extension = NormalizeExtensionFilter(ExtensionFilter);
+	if (!Extension.IsEmpty())
+	{
+		Rules.Include.Add(TEXT("*") + Extension);
+	}
+
+	return FindFiles(OutFiles, PathToDirectory, FileFilter(PathToDirectory, Rules), bRecursive, MaxConcurrency);
+}
+
+bool DirectoryWalkManager::WalkMatchingFiles(const FString& PathToDirectory, const FileFilter& Filter, bool bRecursive, int32 NumWorkers, FFileVisitor OnFile)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	return Walk(PathToDirectory, bRecursive, NumWorkers, [&PlatformFile, &Filter, &OnFile](int32 WorkerIndex, const FString& Directory, const TCHAR* Name, bool bIsDirectory)
+	{
+		if (bIsDirectory)
+		{
+			return Filter.ShouldEnterDirectory(Directory, Name);
+		}
+
+		if (Filter.MatchesName(Directory, Name))
+		{
+			if (Filter.NeedsStat())
+			{
+				const FFileStatData StatData = PlatformFile.GetStatData(*(Directory / Name));
+				if (!StatData.bIsValid || !Filter.MatchesStat(StatData.FileSize, StatData.ModificationTime))
+				{
+					return true;
+				}
+			}
+
+			OnFile(WorkerIndex, Directory, Name);
+		}
+		return true;
+	});
+}
+
+bool DirectoryWalkManager::FindFiles(TArray<FString>& OutFiles, const FString& PathToDirectory, const FileFilter& Filter, bool bRecursive, int32 MaxConcurrency)
+{
+	const int32 NumWorkers = bRecursive ? GetNumWorkers(MaxConcurrency) : 1;
+
+	// One result array per worker, merged at the end, so workers never contend on a lock
+	TArray<TArray<FString>> WorkerFiles;
+	WorkerFiles.SetNum(NumWorkers);
+
+	const bool bRead = WalkMatchingFiles(PathToDirectory, Filter, bRecursive, NumWorkers, [&WorkerFiles](int32 WorkerIndex, const FString& Directory, const TCHAR* Name)
+	{
+		WorkerFiles[WorkerIndex].Add(Directory / Name);
+	});
+
+	const int32 FirstNewFile = OutFiles.Num();
+	int32 NumFiles = OutFiles.Num();
+	for (const TArray<FString>& Files : WorkerFiles)
+	{
+		NumFiles += Files.Num();
+	}
+	OutFiles.Reserve(NumFiles);
+
+	for (TArray<FString>& Files : WorkerFiles)
+	{
+		for (FString& File : Files)
+		{
+			OutFiles.Add(MoveTemp(File));
+		}
+	}
+
+	// Which worker found what changes from run to run, sort so callers always get the same order
+	TArrayView<FString> NewFiles = MakeArrayView(OutFiles).Slice(FirstNewFile, OutFiles.Num() - FirstNewFile);
+	Algo::Sort(NewFiles);
+
+	return bRead;
+}
+
+bool DirectoryWalkManager::FindFiles(CompactPathList& OutFiles, const FString& PathToDirectory, const FileFilter& Filter, bool bRecursive, int32 MaxConcurrency)
+{
+	const int32 NumWorkers = bRecursive ? GetNumWorkers(MaxConcurrency) : 1;
+	OutFiles = CompactPathList(PathToDirectory);
+
+	TArray<CompactPathList> WorkerFiles;
+	for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; WorkerIndex++)
+	{
+		WorkerFiles.Emplace(OutFiles.GetRootPath());
+	}
+
+	const bool bRead = WalkMatchingFiles(PathToDirectory, Filter, bRecursive, NumWorkers, [&WorkerFiles](int32 WorkerIndex, const FString& Directory, const TCHAR* Name)
+	{
+		WorkerFiles[WorkerIndex].AddFile(Directory, Name);
+	});
+
+	for (CompactPathList& Files : WorkerFiles)
+	{
+		OutFiles.Append(MoveTemp(Files));
+	}
+
+	// Same as above, callers index into the result and expect the same file at the same index on every run
+	OutFiles.Sort();
+	OutFiles.Shrink();
+
+	return bRead;
+}
+
+int32 DirectoryWalkManager::GetNumWorkers(int32 MaxConcurrency)
+{
+	return MaxConcurrency > 0 ? MaxConcurrency : ParallelFileWork::GetDefaultConcurrency();
+}
+
+FString DirectoryWalkManager::NormalizeExtensionFilter(const FString& ExtensionFilter)
+{
+	FString Extension = ExtensionFilter;
+	Extension.RemoveFromStart(TEXT("*"));
+	if (!Extension.IsEmpty() && !Extension.StartsWith(TEXT(".")))
+	{
+		Extension.InsertAt(0, TEXT('.'));
+	}
+	return Extension;
+}
+
+DirectoryWalkManager& DirectoryWalkManager::Get()
+{
+#if PLATFORM_LINUX
+	static DirectoryWalkManagerLinux Manager;
+#else
+	static DirectoryWalkManager Manager;
+#endif
+	return Manager;
+}
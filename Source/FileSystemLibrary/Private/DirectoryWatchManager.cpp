@@ -0,0 +1,32 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "DirectoryWatchManager.h"
+#if PLATFORM_LINUX
+#include "Linux/DirectoryWatchManagerLinux.h"
+#endif
+
+DirectoryWatchManager::DirectoryWatchManager()
+{
+}
+
+DirectoryWatchManager::~DirectoryWatchManager()
+{
+}
+
+bool DirectoryWatchManager::StartWatching(const FString& PathToDirectory, bool bRecursive, double DebounceSeconds, FChangesCallback OnChanges)
+{
+	return false;
+}
+
+void DirectoryWatchManager::StopWatching()
+{
+}
+
+TUniquePtr<DirectoryWatchManager> DirectoryWatchManager::Create()
+{
+#if PLATFORM_LINUX
+	return MakeUnique<DirectoryWatchManagerLinux>();
+#else
+	return MakeUnique<DirectoryWatchManager>();
+#endif
+}
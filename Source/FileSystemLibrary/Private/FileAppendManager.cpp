@@ -0,0 +1,555 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "FileAppendManager.h"
+#include "MappedTextFile.h"
+#include "FileStatCache.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
+
+namespace
+{
+	enum class ETextEncoding : uint8
+	{
+		// UTF-8 and ANSI files, ANSI being treated as UTF-8
+		Utf8,
+		Utf16LittleEndian,
+		Utf16BigEndian
+	};
+
+	const int64 PrependChunkSize = 1024 * 1024;
+	const int64 ShiftChunkSize = 1024 * 1024;
+	const float FlushTickInterval = 0.1f;
+
+	/** Reads the encoding from the first bytes of a file, and the size of its BOM. */
+	ETextEncoding DetectEncoding(const uint8* Head, int64 Size, int32& OutBomSize)
+	{
+		if (Size >= 2 && Head[0] == 0xFF && Head[1] == 0xFE)
+		{
+			OutBomSize = 2;
+			return ETextEncoding::Utf16LittleEndian;
+		}
+		if (Size >= 2 && Head[0] == 0xFE && Head[1] == 0xFF)
+		{
+			OutBomSize = 2;
+			return ETextEncoding::Utf16BigEndian;
+		}
+
+		OutBomSize = (Size >= 3 && Head[0] == 0xEF && Head[1] == 0xBB && Head[2] == 0xBF) ? 3 : 0;
+		return ETextEncoding::Utf8;
+	}
+
+	void EncodeText(const FString& Text, ETextEncoding Encoding, TArray<uint8>& OutBytes)
+	{
+		if (Encoding == ETextEncoding::Utf8)
+		{
+			FTCHARToUTF8 Converted(*Text, Text.Len());
+			OutBytes.Append((const uint8*)Converted.Get(), Converted.Length());
+			return;
+		}
+
+		auto Converted = StringCast<UTF16CHAR>(*Text, Text.Len());
+		const int32 Start = OutBytes.Num();
+		OutBytes.Append((const uint8*)Converted.Get(), Converted.Length() * sizeof(UTF16CHAR));
+
+		// Every platform we ship on is little endian
+		if (Encoding == ETextEncoding::Utf16BigEndian)
+		{
+			for (int32 Index = Start; Index + 1 < OutBytes.Num(); Index += 2)
+			{
+				Swap(OutBytes[Index], OutBytes[Index + 1]);
+			}
+		}
+	}
+
+	FString JoinLines(const TArray<FString>& Lines)
+	{
+		int32 Length = 0;
+		for (const FString& Line : Lines)
+		{
+			Length += Line.Len() + FCString::Strlen(LINE_TERMINATOR);
+		}
+
+		// Same layout as FFileHelper::SaveStringArrayToFile, every line followed by a line break
+		FString Text;
+		Text.Reserve(Length);
+		for (const FString& Line : Lines)
+		{
+			Text += Line;
+			Text += LINE_TERMINATOR;
+		}
+		return Text;
+	}
+
+	/** Writes Text at the end of the file in the file's encoding, starting a new line if the last one wasn't terminated. */
+	bool AppendText(const FString& PathToFile, const FString& Text)
+	{
+		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+		PlatformFile.CreateDirectoryTree(*FPaths::GetPath(PathToFile));
+
+		TUniquePtr<IFileHandle> File(PlatformFile.OpenWrite(*PathToFile, true, true));
+		if (!File)
+		{
+			return false;
+		}
+
+		const int64 Size = File->Size();
+		TArray<uint8> Bytes;
+		ETextEncoding Encoding = ETextEncoding::Utf8;
+		bool bNeedsLineBreak = false;
+
+		if (Size == 0)
+		{
+			// A new file is written like FFileHelper's AutoDetect would, ANSI if possible and UTF-16 with a BOM otherwise
+			if (!FCString::IsPureAnsi(*Text))
+			{
+				Encoding = ETextEncoding::Utf16LittleEndian;
+				Bytes.Append({ 0xFF, 0xFE });
+			}
+		}
+		else
+		{
+			// Only the first and last bytes are read, whatever the size of the file
+			uint8 Head[3] = {};
+			uint8 Tail[2] = {};
+			const int64 TailSize = FMath::Min<int64>(Size, 2);
+
+			if (!File->Seek(0) || !File->Read(Head, FMath::Min<int64>(Size, 3))
+				|| !File->Seek(Size - TailSize) || !File->Read(Tail + 2 - TailSize, TailSize))
+			{
+				return false;
+			}
+
+			int32 BomSize = 0;
+			Encoding = DetectEncoding(Head, Size, BomSize);
+
+			if (Size > BomSize)
+			{
+				switch (Encoding)
+				{
+				case ETextEncoding::Utf16LittleEndian:
+					bNeedsLineBreak = !(Tail[0] == '\n' && Tail[1] == 0);
+					break;
+				case ETextEncoding::Utf16BigEndian:
+					bNeedsLineBreak = !(Tail[0] == 0 && Tail[1] == '\n');
+					break;
+				default:
+					bNeedsLineBreak = Tail[1] != '\n';
+					break;
+				}
+			}
+		}
+
+		if (bNeedsLineBreak)
+		{
+			EncodeText(LINE_TERMINATOR, Encoding, Bytes);
+		}
+		EncodeText(Text, Encoding, Bytes);
+
+		const bool bWritten = File->SeekFromEnd(0) && File->Write(Bytes.GetData(), Bytes.Num());
+		File.Reset();
+
+		// The file, and maybe its directories, were created or changed
+		FileStatCache::InvalidatePathAndParents(PathToFile);
+		return bWritten;
+	}
+
+	struct FQueuedAppend
+	{
+		// Held while writing, so two flushes of the same file land in order
+		FCriticalSection WriteLock;
+		FString Text;
+		double FirstQueuedTime = 0.0;
+	};
+
+	typedef TSharedPtr<FQueuedAppend, ESPMode::ThreadSafe> FQueuedAppendPtr;
+
+	FCriticalSection QueueLock;
+	TMap<FString, FQueuedAppendPtr> Queues;
+	int64 FlushSizeBytes = FileAppendManager::DefaultFlushSizeBytes;
+	double FlushIntervalSeconds = FileAppendManager::DefaultFlushIntervalSeconds;
+	FTSTicker::FDelegateHandle TickerHandle;
+	std::atomic<bool> bTimedFlushScheduled(false);
+
+	FString GetQueueKey(const FString& PathToFile)
+	{
+		FString Key = PathToFile;
+		FPaths::NormalizeFilename(Key);
+		return Key;
+	}
+
+	/** Whether the oldest queued line is older than the flush interval, QueueLock must be held. */
+	bool IsDue(const FQueuedAppend& Queued, double Now)
+	{
+		return !Queued.Text.IsEmpty() && Now - Queued.FirstQueuedTime >= FlushIntervalSeconds;
+	}
+
+	bool FlushQueue(const FString& Key, const FQueuedAppendPtr& Queued)
+	{
+		FScopeLock WriteLock(&Queued->WriteLock);
+
+		FString Text;
+		{
+			FScopeLock Lock(&QueueLock);
+			Text = MoveTemp(Queued->Text);
+			Queued->Text.Reset();
+		}
+
+		const bool bWritten = Text.IsEmpty() || AppendText(Key, Text);
+
+		// Forget files nothing was queued for in the meantime, still under the write lock so a new queue can't overtake this write
+		{
+			FScopeLock Lock(&QueueLock);
+			const FQueuedAppendPtr* Current = Queues.Find(Key);
+			if (Queued->Text.IsEmpty() && Current && *Current == Queued)
+			{
+				Queues.Remove(Key);
+			}
+		}
+
+		return bWritten;
+	}
+
+	void FlushDueQueues()
+	{
+		TArray<TPair<FString, FQueuedAppendPtr>> Due;
+		{
+			FScopeLock Lock(&QueueLock);
+			const double Now = FPlatformTime::Seconds();
+			for (const TPair<FString, FQueuedAppendPtr>& Queue : Queues)
+			{
+				if (IsDue(*Queue.Value, Now))
+				{
+					Due.Emplace(Queue.Key, Queue.Value);
+				}
+			}
+		}
+
+		for (const TPair<FString, FQueuedAppendPtr>& Queue : Due)
+		{
+			FlushQueue(Queue.Key, Queue.Value);
+		}
+	}
+
+	bool OnFlushTick(float DeltaTime)
+	{
+		bool bAnyDue = false;
+		{
+			FScopeLock Lock(&QueueLock);
+			const double Now = FPlatformTime::Seconds();
+			for (const TPair<FString, FQueuedAppendPtr>& Queue : Queues)
+			{
+				if (IsDue(*Queue.Value, Now))
+				{
+					bAnyDue = true;
+					break;
+				}
+			}
+		}
+
+		// The ticker runs on the game thread, keep the writes off it
+		if (bAnyDue && !bTimedFlushScheduled.exchange(true))
+		{
+			Async(EAsyncExecution::ThreadPool, []()
+			{
+				FlushDueQueues();
+				bTimedFlushScheduled = false;
+			});
+		}
+
+		return true;
+	}
+}
+
+bool FileAppendManager::AppendLines(const FString& PathToFile, const TArray<FString>& Lines)
+{
+	// Lines queued earlier go first
+	if (!Flush(PathToFile))
+	{
+		return false;
+	}
+
+	return Lines.Num() == 0 || AppendText(PathToFile, JoinLines(Lines));
+}
+
+bool FileAppendManager::PrependLines(const FString& PathToFile, const TArray<FString>& Lines)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!Flush(PathToFile))
+	{
+		return false;
+	}
+
+	TUniquePtr<IFileHandle> Source(PlatformFile.OpenRead(*PathToFile));
+	const int64 Size = Source ? Source->Size() : 0;
+	if (Size == 0)
+	{
+		Source.Reset();
+		return AppendLines(PathToFile, Lines);
+	}
+
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(FMath::Min(Size, PrependChunkSize));
+
+	const int64 HeadSize = FMath::Min<int64>(Size, 3);
+	if (!Source->Read(Buffer.GetData(), HeadSize))
+	{
+		return false;
+	}
+
+	int32 BomSize = 0;
+	const ETextEncoding Encoding = DetectEncoding(Buffer.GetData(), Size, BomSize);
+
+	// The BOM stays first, then the new lines, then the old content
+	TArray<uint8> Bytes;
+	Bytes.Append(Buffer.GetData(), BomSize);
+	EncodeText(JoinLines(Lines), Encoding, Bytes);
+
+	// Write next to the file and swap, a failure never leaves a half written file behind.
+	// Unique names, so no file of the user's is ever overwritten.
+	const FString Directory = FPaths::GetPath(PathToFile);
+	const FString Prefix = FPaths::GetCleanFilename(PathToFile) + TEXT(".");
+	const FString TempPath = FPaths::CreateTempFilename(*Directory, *Prefix, TEXT(".tmp"));
+	{
+		TUniquePtr<IFileHandle> Destination(PlatformFile.OpenWrite(*TempPath));
+		if (!Destination)
+		{
+			return false;
+		}
+
+		bool bWritten = Destination->Write(Bytes.GetData(), Bytes.Num()) && Source->Seek(BomSize);
+		for (int64 Offset = BomSize; bWritten && Offset < Size; Offset += Buffer.Num())
+		{
+			const int64 ChunkSize = FMath::Min<int64>(Buffer.Num(), Size - Offset);
+			bWritten = Source->Read(Buffer.GetData(), ChunkSize) && Destination->Write(Buffer.GetData(), ChunkSize);
+		}
+
+		if (!bWritten)
+		{
+			Destination.Reset();
+			PlatformFile.DeleteFile(*TempPath);
+			return false;
+		}
+	}
+
+	Source.Reset();
+
+	// The original is only deleted once the new file is in place, and put back if that fails
+	const FString AsidePath = FPaths::CreateTempFilename(*Directory, *Prefix, TEXT(".old"));
+	if (!PlatformFile.MoveFile(*AsidePath, *PathToFile))
+	{
+		PlatformFile.DeleteFile(*TempPath);
+		return false;
+	}
+
+	const bool bMoved = PlatformFile.MoveFile(*PathToFile, *TempPath);
+	if (bMoved)
+	{
+		PlatformFile.DeleteFile(*AsidePath);
+	}
+	else
+	{
+		PlatformFile.MoveFile(*PathToFile, *AsidePath);
+		PlatformFile.DeleteFile(*TempPath);
+	}
+
+	FileStatCache::Invalidate(PathToFile);
+	return bMoved;
+}
+
+bool FileAppendManager::InsertLines(const FString& PathToFile, int32 AtLine, const TArray<FString>& Lines, bool bUseLineIndex)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!Flush(PathToFile))
+	{
+		return false;
+	}
+
+	ETextEncoding Encoding;
+	TArray<int64> LineStarts;
+	int64 Size;
+	{
+		TSharedPtr<MappedTextFile, ESPMode::ThreadSafe> TextFile = MappedTextFile::Open(PathToFile, bUseLineIndex);
+		if (!TextFile.IsValid())
+		{
+			return false;
+		}
+
+		int32 BomSize = 0;
+		Encoding = DetectEncoding(TextFile->GetData(), TextFile->GetSize(), BomSize);
+		LineStarts = TextFile->GetLineStarts();
+		Size = TextFile->GetSize();
+
+		// The mapping goes before the file is written to
+	}
+
+	AtLine = FMath::Max(AtLine, 0);
+	if (AtLine >= LineStarts.Num())
+	{
+		return AppendLines(PathToFile, Lines);
+	}
+
+	const int64 InsertOffset = LineStarts[AtLine];
+
+	TArray<uint8> Bytes;
+	TArray<int64> NewLineStarts;
+	NewLineStarts.Reserve(Lines.Num());
+	for (const FString& Line : Lines)
+	{
+		NewLineStarts.Add(InsertOffset + Bytes.Num());
+		EncodeText(Line, Encoding, Bytes);
+		EncodeText(LINE_TERMINATOR, Encoding, Bytes);
+	}
+
+	if (Bytes.Num() == 0)
+	{
+		return true;
+	}
+
+	{
+		TUniquePtr<IFileHandle> File(PlatformFile.OpenWrite(*PathToFile, true, true));
+		if (!File || File->Size() != Size)
+		{
+			return false;
+		}
+
+		// Move the tail from the end backwards, so every block is read before the shift overwrites it
+		TArray<uint8> Buffer;
+		Buffer.SetNumUninitialized(FMath::Min(Size - InsertOffset, ShiftChunkSize));
+
+		bool bWritten = true;
+		for (int64 End = Size; bWritten && End > InsertOffset;)
+		{
+			const int64 ChunkSize = FMath::Min<int64>(Buffer.Num(), End - InsertOffset);
+			const int64 Start = End - ChunkSize;
+
+			bWritten = File->Seek(Start) && File->Read(Buffer.GetData(), ChunkSize)
+				&& File->Seek(Start + Bytes.Num()) && File->Write(Buffer.GetData(), ChunkSize);
+			End = Start;
+		}
+
+		bWritten = bWritten && File->Seek(InsertOffset) && File->Write(Bytes.GetData(), Bytes.Num());
+		File.Reset();
+
+		FileStatCache::Invalidate(PathToFile);
+		if (!bWritten)
+		{
+			return false;
+		}
+	}
+
+	// The lines after the insert only moved, shift their positions instead of scanning the file again
+	if (bUseLineIndex)
+	{
+		for (int32 Index = AtLine; Index < LineStarts.Num(); Index++)
+		{
+			LineStarts[Index] += Bytes.Num();
+		}
+		LineStarts.Insert(NewLineStarts, AtLine);
+		MappedTextFile::SaveLineIndex(PathToFile, LineStarts);
+	}
+
+	return true;
+}
+
+void FileAppendManager::QueueLines(const FString& PathToFile, const TArray<FString>& Lines)
+{
+	if (Lines.Num() == 0)
+	{
+		return;
+	}
+
+	const FString Key = GetQueueKey(PathToFile);
+	const FString Text = JoinLines(Lines);
+	bool bFlushNow = false;
+
+	{
+		FScopeLock Lock(&QueueLock);
+
+		FQueuedAppendPtr& Queued = Queues.FindOrAdd(Key);
+		if (!Queued.IsValid())
+		{
+			Queued = MakeShared<FQueuedAppend, ESPMode::ThreadSafe>();
+		}
+
+		if (Queued->Text.IsEmpty())
+		{
+			Queued->FirstQueuedTime = FPlatformTime::Seconds();
+		}
+		Queued->Text += Text;
+		bFlushNow = Queued->Text.Len() * int64(sizeof(TCHAR)) >= FlushSizeBytes;
+
+		if (!TickerHandle.IsValid())
+		{
+			TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&OnFlushTick), FlushTickInterval);
+		}
+	}
+
+	if (bFlushNow)
+	{
+		Flush(Key);
+	}
+}
+
+bool FileAppendManager::Flush(const FString& PathToFile)
+{
+	const FString Key = GetQueueKey(PathToFile);
+
+	FQueuedAppendPtr Queued;
+	{
+		FScopeLock Lock(&QueueLock);
+		if (const FQueuedAppendPtr* Found = Queues.Find(Key))
+		{
+			Queued = *Found;
+		}
+	}
+
+	return !Queued.IsValid() || FlushQueue(Key, Queued);
+}
+
+bool FileAppendManager::FlushAll()
+{
+	TArray<TPair<FString, FQueuedAppendPtr>> All;
+	{
+		FScopeLock Lock(&QueueLock);
+		for (const TPair<FString, FQueuedAppendPtr>& Queue : Queues)
+		{
+			All.Emplace(Queue.Key, Queue.Value);
+		}
+	}
+
+	bool bAllWritten = true;
+	for (const TPair<FString, FQueuedAppendPtr>& Queue : All)
+	{
+		bAllWritten &= FlushQueue(Queue.Key, Queue.Value);
+	}
+	return bAllWritten;
+}
+
+void FileAppendManager::SetFlushThresholds(int64 InFlushSizeBytes, double InFlushIntervalSeconds)
+{
+	FScopeLock Lock(&QueueLock);
+	FlushSizeBytes = FMath::Max<int64>(InFlushSizeBytes, 0);
+	FlushIntervalSeconds = FMath::Max(InFlushIntervalSeconds, 0.0);
+}
+
+void FileAppendManager::Shutdown()
+{
+	{
+		FScopeLock Lock(&QueueLock);
+		if (TickerHandle.IsValid())
+		{
+			FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+			TickerHandle.Reset();
+		}
+	}
+
+	FlushAll();
+}
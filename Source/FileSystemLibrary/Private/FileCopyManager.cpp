@@ -0,0 +1,483 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "FileCopyManager.h"
+#if PLATFORM_LINUX
+#include "Linux/FileCopyManagerLinux.h"
+#endif
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Templates/UniquePtr.h"
+#include "ParallelFileWork.h"
+#include "Misc/Paths.h"
+#include "DirectoryGraveyard.h"
+#include "FileHashManager.h"
+#include <atomic>
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/MinWindows.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <sys/stat.h>
+#endif
+
+FileCopyManager::FileCopyManager()
+{
+}
+
+FileCopyManager::~FileCopyManager()
+{
+}
+
+EFileCopyResult FileCopyManager::CopyFile(const FString& PathToFile, const FString& DestinationFilePath, const FThreadSafeBool* CancelFlag, const FProgressCallback& OnProgress, int64 ChunkSize)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IFileHandle> Source(PlatformFile.OpenRead(*PathToFile, true));
+	if (!Source)
+	{
+		return EFileCopyResult::Failed;
+	}
+
+	TUniquePtr<IFileHandle> Destination(PlatformFile.OpenWrite(*DestinationFilePath, false, true));
+	if (!Destination)
+	{
+		return EFileCopyResult::Failed;
+	}
+
+	const int64 TotalBytes = Source->Size();
+
+	// Never allocate more than the file needs, small files are common in directory copies
+	ChunkSize = FMath::Max<int64>(ChunkSize, CopyAlignment);
+	ChunkSize = FMath::Min<int64>(ChunkSize, FMath::Max<int64>(TotalBytes, 1));
+	ChunkSize = Align(ChunkSize, CopyAlignment);
+
+	uint8* Buffer = (uint8*)FMemory::Malloc(ChunkSize, CopyAlignment);
+
+	EFileCopyResult Result = EFileCopyResult::Success;
+	int64 BytesCopied = 0;
+
+	while (BytesCopied < TotalBytes)
+	{
+		if (CancelFlag && *CancelFlag)
+		{
+			Result = EFileCopyResult::Cancelled;
+			break;
+		}
+
+		const int64 BytesToCopy = FMath::Min<int64>(ChunkSize, TotalBytes - BytesCopied);
+
+		if (!Source->Read(Buffer, BytesToCopy) || !Destination->Write(Buffer, BytesToCopy))
+		{
+			Result = EFileCopyResult::Failed;
+			break;
+		}
+
+		BytesCopied += BytesToCopy;
+
+		if (OnProgress)
+		{
+			OnProgress(BytesCopied, TotalBytes);
+		}
+	}
+
+	FMemory::Free(Buffer);
+
+	// Make sure the handle is closed before cleaning up a partial copy
+	Destination.Reset();
+
+	if (Result != EFileCopyResult::Success)
+	{
+		PlatformFile.DeleteFile(*DestinationFilePath);
+	}
+
+	return Result;
+}
+
+bool FileCopyManager::CopyDirectory(const FString& PathToDirectory, const FString& NewPathToDirectory, bool bOverwrite, int32 MaxConcurrency, FDirectoryCopyStats& OutStats)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const double StartTime = FPlatformTime::Seconds();
+
+	std::atomic<int64> FilesCopied(0);
+	std::atomic<int64> FilesSkipped(0);
+	std::atomic<int64> BytesCopied(0);
+	std::atomic<int64> Failures(0);
+
+	FileTaskScheduler Scheduler(MaxConcurrency);
+
+	// Copies one file, stat data comes from the directory listing so we never stat the source twice
+	auto CopyOneFile = [this, &PlatformFile, bOverwrite, &FilesCopied, &FilesSkipped, &BytesCopied, &Failures](const FString& From, const FString& To, int64 FileSize)
+	{
+		if (Failures > 0)
+		{
+			return;
+		}
+
+		if (PlatformFile.FileExists(*To))
+		{
+			if (!bOverwrite)
+			{
+				FilesSkipped++;
+				return;
+			}
+			PlatformFile.SetReadOnly(*To, false);
+		}
+
+		if (CopyFile(From, To) == EFileCopyResult::Success)
+		{
+			FilesCopied++;
+			BytesCopied += FileSize;
+		}
+		else
+		{
+			Failures++;
+		}
+	};
+
+	// Creates the destination directory and queues one task per entry, sub-directories discover their own content
+	TFunction<void(const FString&, const FString&, FileTaskScheduler&, int32)> CopyOneDirectory;
+	CopyOneDirectory = [&PlatformFile, &Failures, &CopyOneFile, &CopyOneDirectory](const FString& From, const FString& To, FileTaskScheduler& InScheduler, int32 WorkerIndex)
+	{
+		if (Failures > 0)
+		{
+			return;
+		}
+
+		if (!PlatformFile.DirectoryExists(*To) && !PlatformFile.CreateDirectory(*To))
+		{
+			Failures++;
+			return;
+		}
+
+		PlatformFile.IterateDirectoryStat(*From, [&](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+		{
+			const FString SourcePath = FilenameOrDirectory;
+			const FString DestinationPath = To / FPaths::GetCleanFilename(SourcePath);
+
+			if (StatData.bIsDirectory)
+			{
+				InScheduler.Spawn(WorkerIndex, [SourcePath, DestinationPath, &CopyOneDirectory](FileTaskScheduler& TaskScheduler, int32 TaskWorkerIndex)
+				{
+					CopyOneDirectory(SourcePath, DestinationPath, TaskScheduler, TaskWorkerIndex);
+				});
+			}
+			else
+			{
+				const int64 FileSize = StatData.FileSize;
+				InScheduler.Spawn(WorkerIndex, [SourcePath, DestinationPath, FileSize, &CopyOneFile](FileTaskScheduler& TaskScheduler, int32 TaskWorkerIndex)
+				{
+					CopyOneFile(SourcePath, DestinationPath, FileSize);
+				});
+			}
+			return true;
+		});
+	};
+
+	if (PlatformFile.DirectoryExists(*PathToDirectory) && PlatformFile.CreateDirectoryTree(*NewPathToDirectory))
+	{
+		const FString From = PathToDirectory;
+		const FString To = NewPathToDirectory;
+		Scheduler.Spawn(0, [From, To, &CopyOneDirectory](FileTaskScheduler& TaskScheduler, int32 TaskWorkerIndex)
+		{
+			CopyOneDirectory(From, To, TaskScheduler, TaskWorkerIndex);
+		});
+		Scheduler.Run();
+	}
+	else
+	{
+		Failures++;
+	}
+
+	OutStats.FilesCopied = FilesCopied;
+	OutStats.FilesSkipped = FilesSkipped;
+	OutStats.BytesCopied = BytesCopied;
+	OutStats.Failures = Failures;
+	OutStats.Seconds = FPlatformTime::Seconds() - StartTime;
+
+	return OutStats.Failures == 0;
+}
+
+bool FileCopyManager::SyncDirectory(const FString& PathToDirectory, const FString& NewPathToDirectory, bool bDeleteOrphans, bool bCompareContent, int32 MaxConcurrency, FDirectorySyncStats& OutStats)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const double StartTime = FPlatformTime::Seconds();
+
+	OutStats = FDirectorySyncStats();
+
+	if (!PlatformFile.DirectoryExists(*PathToDirectory) || !PlatformFile.CreateDirectoryTree(*NewPathToDirectory))
+	{
+		OutStats.Failures++;
+		return false;
+	}
+
+	// One stat-ing walk per side, keyed by path relative to the root
+	auto ListTree = [&PlatformFile](const FString& Root, TMap<FString, FFileStatData>& OutFiles, TArray<FString>& OutDirectories)
+	{
+		FString RootPrefix = Root;
+		FPaths::NormalizeDirectoryName(RootPrefix);
+		RootPrefix /= TEXT("");
+
+		PlatformFile.IterateDirectoryStatRecursively(*Root, [&](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+		{
+			FString RelativePath = FilenameOrDirectory;
+			FPaths::MakePathRelativeTo(RelativePath, *RootPrefix);
+
+			if (StatData.bIsDirectory)
+			{
+				OutDirectories.Add(MoveTemp(RelativePath));
+			}
+			else
+			{
+				OutFiles.Add(MoveTemp(RelativePath), StatData);
+			}
+			return true;
+		});
+	};
+
+	TMap<FString, FFileStatData> SourceFiles;
+	TMap<FString, FFileStatData> DestinationFiles;
+	TArray<FString> SourceDirectories;
+	TArray<FString> DestinationDirectories;
+
+	ListTree(PathToDirectory, SourceFiles, SourceDirectories);
+	ListTree(NewPathToDirectory, DestinationFiles, DestinationDirectories);
+
+	// Parents sort before their children, so every CreateDirectory has an existing parent
+	SourceDirectories.Sort();
+	for (const FString& Directory : SourceDirectories)
+	{
+		const FString DestinationDirectory = NewPathToDirectory / Directory;
+		if (!PlatformFile.DirectoryExists(*DestinationDirectory) && !PlatformFile.CreateDirectory(*DestinationDirectory))
+		{
+			OutStats.Failures++;
+		}
+	}
+
+	// Metadata checks are cheap and done here, content checks are deferred to the workers
+	TArray<const TPair<FString, FFileStatData>*> Candidates;
+	for (const TPair<FString, FFileStatData>& SourceFile : SourceFiles)
+	{
+		const FFileStatData* DestinationStat = DestinationFiles.Find(SourceFile.Key);
+
+		const bool bSameSize = DestinationStat && DestinationStat->FileSize == SourceFile.Value.FileSize;
+		const bool bSameTime = DestinationStat && FMath::Abs((DestinationStat->ModificationTime - SourceFile.Value.ModificationTime).GetTotalSeconds()) <= 2.0;
+
+		if (bSameSize && bSameTime && !bCompareContent)
+		{
+			OutStats.FilesSkipped++;
+			OutStats.BytesSkipped += SourceFile.Value.FileSize;
+			continue;
+		}
+
+		Candidates.Add(&SourceFile);
+	}
+
+	std::atomic<int64> FilesCopied(0);
+	std::atomic<int64> FilesSkipped(0);
+	std::atomic<int64> BytesCopied(0);
+	std::atomic<int64> BytesSkipped(0);
+	std::atomic<int64> Failures(0);
+
+	ParallelFileWork::ForEach(Candidates.Num(), MaxConcurrency, [&](int32 Index)
+	{
+		const FString& RelativePath = Candidates[Index]->Key;
+		const FFileStatData& SourceStat = Candidates[Index]->Value;
+		const FString From = PathToDirectory / RelativePath;
+		const FString To = NewPathToDirectory / RelativePath;
+
+		if (bCompareContent)
+		{
+			const FFileStatData* DestinationStat = DestinationFiles.Find(RelativePath);
+			if (DestinationStat && DestinationStat->FileSize == SourceStat.FileSize && FileHashManager::HashFile(From, EFileHashType::XxHash3) == FileHashManager::HashFile(To, EFileHashType::XxHash3))
+			{
+				FilesSkipped++;
+				BytesSkipped += SourceStat.FileSize;
+				return;
+			}
+		}
+
+		if (DestinationFiles.Contains(RelativePath))
+		{
+			PlatformFile.SetReadOnly(*To, false);
+		}
+
+		if (CopyFile(From, To) == EFileCopyResult::Success)
+		{
+			PlatformFile.SetTimeStamp(*To, SourceStat.ModificationTime);
+			FilesCopied++;
+			BytesCopied += SourceStat.FileSize;
+		}
+		else
+		{
+			Failures++;
+		}
+	});
+
+	OutStats.FilesCopied = FilesCopied;
+	OutStats.FilesSkipped += FilesSkipped;
+	OutStats.BytesCopied = BytesCopied;
+	OutStats.BytesSkipped += BytesSkipped;
+	OutStats.Failures += Failures;
+
+	if (bDeleteOrphans)
+	{
+		for (const TPair<FString, FFileStatData>& DestinationFile : DestinationFiles)
+		{
+			if (!SourceFiles.Contains(DestinationFile.Key))
+			{
+				const FString OrphanPath = NewPathToDirectory / DestinationFile.Key;
+				PlatformFile.SetReadOnly(*OrphanPath, false);
+				if (PlatformFile.DeleteFile(*OrphanPath))
+				{
+					OutStats.FilesDeleted++;
+				}
+				else
+				{
+					OutStats.Failures++;
+				}
+			}
+		}
+
+		// Children sort after their parents, delete deepest first so every directory is empty when we reach it
+		TSet<FString> SourceDirectorySet(SourceDirectories);
+		DestinationDirectories.Sort([](const FString& A, const FString& B) { return A > B; });
+		for (const FString& Directory : DestinationDirectories)
+		{
+			if (!SourceDirectorySet.Contains(Directory) && !PlatformFile.DeleteDirectory(*(NewPathToDirectory / Directory)))
+			{
+				OutStats.Failures++;
+			}
+		}
+	}
+
+	OutStats.Seconds = FPlatformTime::Seconds() - StartTime;
+
+	return OutStats.Failures == 0;
+}
+
+EFileMoveResult FileCopyManager::MoveFile(const FString& PathToFile, const FString& DestinationFilePath)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!PlatformFile.FileExists(*PathToFile))
+	{
+		return EFileMoveResult::Failed;
+	}
+
+	if (IsSameVolume(PathToFile, DestinationFilePath))
+	{
+		return PlatformFile.MoveFile(*DestinationFilePath, *PathToFile) ? EFileMoveResult::Renamed : EFileMoveResult::Failed;
+	}
+
+	if (CopyFile(PathToFile, DestinationFilePath) == EFileCopyResult::Success && PlatformFile.DeleteFile(*PathToFile))
+	{
+		return EFileMoveResult::CopiedAndDeleted;
+	}
+
+	return EFileMoveResult::Failed;
+}
+
+EFileMoveResult FileCopyManager::MoveDirectory(const FString& PathToDirectory, const FString& NewPathToDirectory, bool bOverwrite)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!PlatformFile.DirectoryExists(*PathToDirectory))
+	{
+		return EFileMoveResult::Failed;
+	}
+
+	if (IsSameVolume(PathToDirectory, NewPathToDirectory))
+	{
+		// A rename can't merge into existing content, only replace an empty destination
+		bool bDestinationIsEmpty = true;
+		if (PlatformFile.DirectoryExists(*NewPathToDirectory))
+		{
+			PlatformFile.IterateDirectory(*NewPathToDirectory, [&bDestinationIsEmpty](const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+			{
+				bDestinationIsEmpty = false;
+				return false;
+			});
+
+			if (bDestinationIsEmpty)
+			{
+				PlatformFile.DeleteDirectory(*NewPathToDirectory);
+			}
+		}
+
+		if (bDestinationIsEmpty)
+		{
+			PlatformFile.CreateDirectoryTree(*FPaths::GetPath(NewPathToDirectory));
+
+			if (PlatformFile.MoveFile(*NewPathToDirectory, *PathToDirectory))
+			{
+				return EFileMoveResult::Renamed;
+			}
+		}
+	}
+
+	FDirectoryCopyStats Stats;
+	if (!CopyDirectory(PathToDirectory, NewPathToDirectory, bOverwrite, 0, Stats))
+	{
+		return EFileMoveResult::Failed;
+	}
+
+	// The copy is complete, the caller doesn't need to wait for the source to be gone
+	return DirectoryGraveyard::Bury(PathToDirectory) ? EFileMoveResult::CopiedAndDeleted : EFileMoveResult::Failed;
+}
+
+bool FileCopyManager::IsSameVolume(const FString& PathA, const FString& PathB) const
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	// Walk up to a path that exists so destinations that are about to be created can be compared
+	auto ClosestExistingPath = [&PlatformFile](const FString& Path)
+	{
+		FString ExistingPath = FPaths::ConvertRelativePathToFull(Path);
+		while (!ExistingPath.IsEmpty() && !PlatformFile.FileExists(*ExistingPath) && !PlatformFile.DirectoryExists(*ExistingPath))
+		{
+			const FString ParentPath = FPaths::GetPath(ExistingPath);
+			if (ParentPath == ExistingPath)
+			{
+				break;
+			}
+			ExistingPath = ParentPath;
+		}
+		return ExistingPath;
+	};
+
+	const FString ExistingA = ClosestExistingPath(PathA);
+	const FString ExistingB = ClosestExistingPath(PathB);
+
+#if PLATFORM_WINDOWS
+	TCHAR VolumeA[MAX_PATH];
+	TCHAR VolumeB[MAX_PATH];
+
+	if (!::GetVolumePathNameW(*ExistingA.Replace(TEXT("/"), TEXT("\\")), VolumeA, MAX_PATH) || !::GetVolumePathNameW(*ExistingB.Replace(TEXT("/"), TEXT("\\")), VolumeB, MAX_PATH))
+	{
+		return false;
+	}
+
+	return FCString::Stricmp(VolumeA, VolumeB) == 0;
+#else
+	struct stat StatA;
+	struct stat StatB;
+
+	if (stat(TCHAR_TO_UTF8(*ExistingA), &StatA) != 0 || stat(TCHAR_TO_UTF8(*ExistingB), &StatB) != 0)
+	{
+		return false;
+	}
+
+	return StatA.st_dev == StatB.st_dev;
+#endif
+}
+
+FileCopyManager& FileCopyManager::Get()
+{
+#if PLATFORM_LINUX
+	static FileCopyManagerLinux Manager;
+#else
+	static FileCopyManager Manager;
+#endif
+	return Manager;
+}
@@ -0,0 +1,210 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "FileFilter.h"
+#include "Misc/Paths.h"
+
+FileFilter::FileFilter(const FString& RootDirectory, const FFileFilterRules& Rules)
+	: MinSizeBytes(Rules.MinSizeBytes)
+	, MaxSizeBytes(Rules.MaxSizeBytes)
+	, ModifiedAfter(Rules.ModifiedAfter)
+	, ModifiedBefore(Rules.ModifiedBefore)
+{
+	FString Root = RootDirectory;
+	FPaths::NormalizeDirectoryName(Root);
+	RootLength = Root.Len();
+
+	Include = Compile(Rules.Include, bIncludeHasPaths);
+	Exclude = Compile(Rules.Exclude, bExcludeHasPaths);
+	ExcludeDirectories = Compile(Rules.ExcludeDirectories, bExcludeDirectoriesHasPaths);
+
+	bNeedsStat = MinSizeBytes >= 0 || MaxSizeBytes >= 0 || ModifiedAfter != FDateTime::MinValue() || ModifiedBefore != FDateTime::MaxValue();
+}
+
+TArray<FileFilter::FCompiledPattern> FileFilter::Compile(const TArray<FString>& Patterns, bool& bOutAnyPathPattern)
+{
+	TArray<FCompiledPattern> Compiled;
+
+	for (FString Pattern : Patterns)
+	{
+		Pattern.TrimStartAndEndInline();
+		Pattern.ReplaceInline(TEXT("\\"), TEXT("/"));
+		Pattern.RemoveFromStart(TEXT("/"));
+		if (Pattern.IsEmpty())
+		{
+			continue;
+		}
+
+		FCompiledPattern& Entry = Compiled.AddDefaulted_GetRef();
+		Entry.bMatchesPath = Pattern.Contains(TEXT("/"));
+		bOutAnyPathPattern |= Entry.bMatchesPath;
+
+		int32 FirstWildcard = INDEX_NONE;
+		int32 NumWildcards = 0;
+		for (int32 Index = 0; Index < Pattern.Len(); Index++)
+		{
+			if (Pattern[Index] == TEXT('*') || Pattern[Index] == TEXT('?'))
+			{
+				if (FirstWildcard == INDEX_NONE)
+				{
+					FirstWildcard = Index;
+				}
+				NumWildcards++;
+			}
+		}
+
+		// Most patterns are "*.ext" or "name*", which need no backtracking
+		if (NumWildcards == 0)
+		{
+			Entry.Kind = FCompiledPattern::EKind::Literal;
+			Entry.Text = Pattern;
+		}
+		else if (NumWildcards == 1 && FirstWildcard == 0 && Pattern[0] == TEXT('*') && !Entry.bMatchesPath)
+		{
+			Entry.Kind = FCompiledPattern::EKind::Suffix;
+			Entry.Text = Pattern.RightChop(1);
+		}
+		else if (NumWildcards == 1 && FirstWildcard == Pattern.Len() - 1 && Pattern[FirstWildcard] == TEXT('*') && !Entry.bMatchesPath)
+		{
+			Entry.Kind = FCompiledPattern::EKind::Prefix;
+			Entry.Text = Pattern.LeftChop(1);
+		}
+		else
+		{
+			Entry.Kind = FCompiledPattern::EKind::Glob;
+			Entry.Text = Pattern;
+		}
+	}
+
+	return Compiled;
+}
+
+bool FileFilter::MatchesGlob(const TCHAR* Pattern, const TCHAR* Text)
+{
+	for (; *Pattern; Pattern++, Text++)
+	{
+		if (*Pattern == TEXT('*'))
+		{
+			const bool bCrossesSeparators = Pattern[1] == TEXT('*');
+			while (*Pattern == TEXT('*'))
+			{
+				Pattern++;
+			}
+
+			// "**/" also matches no directory at all
+			if (bCrossesSeparators && *Pattern == TEXT('/') && MatchesGlob(Pattern + 1, Text))
+			{
+				return true;
+			}
+
+			for (;; Text++)
+			{
+				if (MatchesGlob(Pattern, Text))
+				{
+					return true;
+				}
+				if (!*Text || (!bCrossesSeparators && *Text == TEXT('/')))
+				{
+					return false;
+				}
+			}
+		}
+
+		if (!*Text)
+		{
+			return false;
+		}
+
+		if (*Pattern == TEXT('?'))
+		{
+			if (*Text == TEXT('/'))
+			{
+				return false;
+			}
+		}
+		else if (FChar::ToLower(*Pattern) != FChar::ToLower(*Text))
+		{
+			return false;
+		}
+	}
+
+	return *Text == 0;
+}
+
+bool FileFilter::MatchesAny(const TArray<FCompiledPattern>& Patterns, bool bAnyPathPattern, const FString& Directory, const TCHAR* Name) const
+{
+	// Relative path for path patterns, built in a per-thread buffer that is reused for every entry
+	static thread_local FString RelativePath;
+	if (bAnyPathPattern)
+	{
+		RelativePath.Reset();
+		if (Directory.Len() > RootLength)
+		{
+			RelativePath.AppendChars(*Directory + RootLength + 1, Directory.Len() - RootLength - 1);
+			RelativePath.AppendChar(TEXT('/'));
+		}
+		RelativePath.Append(Name);
+	}
+
+	const int32 NameLength = FCString::Strlen(Name);
+
+	for (const FCompiledPattern& Pattern : Patterns)
+	{
+		switch (Pattern.Kind)
+		{
+		case FCompiledPattern::EKind::Literal:
+			if (FCString::Stricmp(Pattern.bMatchesPath ? *RelativePath : Name, *Pattern.Text) == 0)
+			{
+				return true;
+			}
+			break;
+
+		case FCompiledPattern::EKind::Suffix:
+			if (NameLength >= Pattern.Text.Len() && FCString::Stricmp(Name + NameLength - Pattern.Text.Len(), *Pattern.Text) == 0)
+			{
+				return true;
+			}
+			break;
+
+		case FCompiledPattern::EKind::Prefix:
+			if (FCString::Strnicmp(Name, *Pattern.Text, Pattern.Text.Len()) == 0)
+			{
+				return true;
+			}
+			break;
+
+		default:
+			if (MatchesGlob(*Pattern.Text, Pattern.bMatchesPath ? *RelativePath : Name))
+			{
+				return true;
+			}
+			break;
+		}
+	}
+
+	return false;
+}
+
+bool FileFilter::ShouldEnterDirectory(const FString& Directory, const TCHAR* Name) const
+{
+	return ExcludeDirectories.Num() == 0 || !MatchesAny(ExcludeDirectories, bExcludeDirectoriesHasPaths, Directory, Name);
+}
+
+bool FileFilter::MatchesName(const FString& Directory, const TCHAR* Name) const
+{
+	if (Include.Num() > 0 && !MatchesAny(Include, bIncludeHasPaths, Directory, Name))
+	{
+		return false;
+	}
+
+	return Exclude.Num() == 0 || !MatchesAny(Exclude, bExcludeHasPaths, Directory, Name);
+}
+
+bool FileFilter::MatchesStat(int64 Size, const FDateTime& ModificationTime) const
+{
+	if ((MinSizeBytes >= 0 && Size < MinSizeBytes) || (MaxSizeBytes >= 0 && Size > MaxSizeBytes))
+	{
+		return false;
+	}
+
+	return ModificationTime >= ModifiedAfter && ModificationTime <= ModifiedBefore;
+}
@@ -0,0 +1,339 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "FileHashManager.h"
+#include "ParallelFileWork.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Hash/xxhash.h"
+#include "Hash/Blake3.h"
+#include "Templates/UniquePtr.h"
+#include <atomic>
+
+namespace
+{
+	const TCHAR* ManifestHeader = TEXT("# FileSystemLibrary manifest ");
+	const TCHAR* ManifestSeparator = TEXT("  ");
+}
+
+const TCHAR* FileHashManager::GetHashTypeName(EFileHashType HashType)
+{
+	return HashType == EFileHashType::Blake3 ? TEXT("blake3") : TEXT("xxh3");
+}
+
+FString FileHashManager::HashFile(const FString& PathToFile, EFileHashType HashType, int64 Offset, int64 Length)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IFileHandle> File(PlatformFile.OpenRead(*PathToFile, true));
+	if (!File)
+	{
+		return FString();
+	}
+
+	const int64 FileSize = File->Size();
+	Offset = FMath::Clamp<int64>(Offset, 0, FileSize);
+	Length = Length < 0 ? FileSize - Offset : FMath::Min<int64>(Length, FileSize - Offset);
+
+	if (Offset > 0 && !File->Seek(Offset))
+	{
+		return FString();
+	}
+
+	// Both hashers consume the same stream, only the one in use is fed
+	FXxHash64Builder XxHashBuilder;
+	FBlake3 Blake3Builder;
+
+	const int64 BufferSize = FMath::Max<int64>(FMath::Min<int64>(HashBufferSize, Length), 1);
+	uint8* Buffer = (uint8*)FMemory::Malloc(BufferSize, 4096);
+
+	bool bSuccess = true;
+	for (int64 Remaining = Length; Remaining > 0;)
+	{
+		const int64 BytesToRead = FMath::Min<int64>(BufferSize, Remaining);
+		if (!File->Read(Buffer, BytesToRead))
+		{
+			bSuccess = false;
+			break;
+		}
+
+		if (HashType == EFileHashType::Blake3)
+		{
+			Blake3Builder.Update(Buffer, BytesToRead);
+		}
+		else
+		{
+			XxHashBuilder.Update(Buffer, BytesToRead);
+		}
+
+		Remaining -= BytesToRead;
+	}
+
+	FMemory::Free(Buffer);
+
+	if (!bSuccess)
+	{
+		return FString();
+	}
+
+	if (HashType == EFileHashType::Blake3)
+	{
+		const FBlake3Hash Hash = Blake3Builder.Finalize();
+		return BytesToHex(Hash.GetBytes(), sizeof(FBlake3Hash::ByteArray)).ToLower();
+	}
+
+	return FString::Printf(TEXT("%016llx"), (unsigned long long)XxHashBuilder.Finalize().Hash);
+}
+
+void FileHashManager::HashFiles(const TArray<FString>& Files, EFileHashType HashType, int32 MaxConcurrency, TArray<FString>& OutHashes)
+{
+	OutHashes.Reset();
+	OutHashes.SetNum(Files.Num());
+
+	ParallelFileWork::ForEach(Files.Num(), MaxConcurrency, [&Files, HashType, &OutHashes](int32 Index)
+	{
+		OutHashes[Index] = HashFile(Files[Index], HashType);
+	});
+}
+
+bool FileHashManager::HashDirectory(const FString& PathToDirectory, EFileHashType HashType, int32 MaxConcurrency, TArray<FString>& OutRelativePaths, TArray<FString>& OutHashes)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	OutRelativePaths.Reset();
+	OutHashes.Reset();
+
+	if (!PlatformFile.DirectoryExists(*PathToDirectory))
+	{
+		return false;
+	}
+
+	FString RootPrefix = PathToDirectory;
+	FPaths::NormalizeDirectoryName(RootPrefix);
+	RootPrefix /= TEXT("");
+
+	PlatformFile.IterateDirectoryRecursively(*PathToDirectory, [&OutRelativePaths, &RootPrefix](const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+	{
+		if (!bIsDirectory)
+		{
+			FString RelativePath = FilenameOrDirectory;
+			FPaths::MakePathRelativeTo(RelativePath, *RootPrefix);
+			OutRelativePaths.Add(MoveTemp(RelativePath));
+		}
+		return true;
+	});
+
+	// Sorted so two manifests of the same tree are identical
+	OutRelativePaths.Sort();
+
+	OutHashes.SetNum(OutRelativePaths.Num());
+	std::atomic<int32> Failures(0);
+
+	ParallelFileWork::ForEach(OutRelativePaths.Num(), MaxConcurrency, [&](int32 Index)
+	{
+		OutHashes[Index] = HashFile(PathToDirectory / OutRelativePaths[Index], HashType);
+		if (OutHashes[Index].IsEmpty())
+		{
+			Failures++;
+		}
+	});
+
+	return Failures == 0;
+}
+
+bool FileHashManager::WriteManifest(const FString& ManifestPath, EFileHashType HashType, const TArray<FString>& RelativePaths, const TArray<FString>& Hashes)
+{
+	if (RelativePaths.Num() != Hashes.Num())
+	{
+		return false;
+	}
+
+	TArray<FString> Lines;
+	Lines.Reserve(RelativePaths.Num() + 1);
+	Lines.Add(FString(ManifestHeader) + GetHashTypeName(HashType));
+
+	for (int32 Index = 0; Index < RelativePaths.Num(); Index++)
+	{
+		Lines.Add(Hashes[Index] + ManifestSeparator + RelativePaths[Index]);
+	}
+
+	return FFileHelper::SaveStringArrayToFile(Lines, *ManifestPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+bool FileHashManager::VerifyManifest(const FString& PathToDirectory, const FString& ManifestPath, int32 MaxConcurrency, TArray<FString>& OutChangedFiles, TArray<FString>& OutMissingFiles)
+{
+	OutChangedFiles.Reset();
+	OutMissingFiles.Reset();
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *ManifestPath) || Lines.Num() == 0 || !Lines[0].StartsWith(ManifestHeader))
+	{
+		return false;
+	}
+
+	const EFileHashType HashType = Lines[0].EndsWith(GetHashTypeName(EFileHashType::Blake3)) ? EFileHashType::Blake3 : EFileHashType::XxHash3;
+
+	TArray<FString> RelativePaths;
+	TArray<FString> ExpectedHashes;
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); LineIndex++)
+	{
+		FString Hash;
+		FString RelativePath;
+		if (Lines[LineIndex].Split(ManifestSeparator, &Hash, &RelativePath))
+		{
+			ExpectedHashes.Add(MoveTemp(Hash));
+			RelativePaths.Add(MoveTemp(RelativePath));
+		}
+	}
+
+	// 0 = match, 1 = changed, 2 = missing
+	TArray<uint8> Outcomes;
+	Outcomes.SetNumZeroed(RelativePaths.Num());
+
+	ParallelFileWork::ForEach(RelativePaths.Num(), MaxConcurrency, [&](int32 Index)
+	{
+		const FString Hash = HashFile(PathToDirectory / RelativePaths[Index], HashType);
+		if (Hash.IsEmpty())
+		{
+			Outcomes[Index] = 2;
+		}
+		else if (Hash != ExpectedHashes[Index])
+		{
+			Outcomes[Index] = 1;
+		}
+	});
+
+	for (int32 Index = 0; Index < RelativePaths.Num(); Index++)
+	{
+		if (Outcomes[Index] == 1)
+		{
+			OutChangedFiles.Add(RelativePaths[Index]);
+		}
+		else if (Outcomes[Index] == 2)
+		{
+			OutMissingFiles.Add(RelativePaths[Index]);
+		}
+	}
+
+	return OutChangedFiles.Num() == 0 && OutMissingFiles.Num() == 0;
+}
+
+void FileHashManager::FindDuplicateFiles(const TArray<FString>& Files, int32 MaxConcurrency, TArray<TArray<FString>>& OutGroups, TArray<int64>& OutFileSizes)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	OutGroups.Reset();
+	OutFileSizes.Reset();
+
+	// Pass 1: sizes, a file with a unique size can't have a duplicate
+	TArray<int64> Sizes;
+	Sizes.SetNumUninitialized(Files.Num());
+
+	ParallelFileWork::ForEach(Files.Num(), MaxConcurrency, [&PlatformFile, &Files, &Sizes](int32 Index)
+	{
+		Sizes[Index] = PlatformFile.FileSize(*Files[Index]);
+	});
+
+	TMap<int64, TArray<int32>> SizeBuckets;
+	for (int32 Index = 0; Index < Files.Num(); Index++)
+	{
+		if (Sizes[Index] > 0)
+		{
+			SizeBuckets.FindOrAdd(Sizes[Index]).Add(Index);
+		}
+	}
+
+	TArray<int32> Candidates;
+	for (const TPair<int64, TArray<int32>>& Bucket : SizeBuckets)
+	{
+		if (Bucket.Value.Num() > 1)
+		{
+			Candidates.Append(Bucket.Value);
+		}
+	}
+
+	// Pass 2: head and tail, catches most same-size files with different content for two small reads
+	TArray<FString> PartialHashes;
+	PartialHashes.SetNum(Candidates.Num());
+
+	ParallelFileWork::ForEach(Candidates.Num(), MaxConcurrency, [&](int32 CandidateIndex)
+	{
+		const int32 Index = Candidates[CandidateIndex];
+		const int64 Size = Sizes[Index];
+
+		PartialHashes[CandidateIndex] = HashFile(Files[Index], EFileHashType::XxHash3, 0, PartialHashSize);
+		if (Size > PartialHashSize)
+		{
+			PartialHashes[CandidateIndex] += HashFile(Files[Index], EFileHashType::XxHash3, FMath::Max<int64>(Size - PartialHashSize, PartialHashSize), PartialHashSize);
+		}
+	});
+
+	// Groups of file indices sharing size and hash, keyed by "<size>:<hash>"
+	auto GroupByHash = [&Sizes](const TArray<int32>& Indices, const TArray<FString>& Hashes)
+	{
+		TMap<FString, TArray<int32>> Groups;
+		for (int32 Position = 0; Position < Indices.Num(); Position++)
+		{
+			if (!Hashes[Position].IsEmpty())
+			{
+				Groups.FindOrAdd(FString::Printf(TEXT("%lld:%s"), Sizes[Indices[Position]], *Hashes[Position])).Add(Indices[Position]);
+			}
+		}
+		return Groups;
+	};
+
+	TArray<TArray<int32>> DuplicateGroups;
+	TArray<int32> FullHashCandidates;
+
+	for (TPair<FString, TArray<int32>>& Group : GroupByHash(Candidates, PartialHashes))
+	{
+		if (Group.Value.Num() < 2)
+		{
+			continue;
+		}
+
+		// The partial hash already covered the whole file
+		if (Sizes[Group.Value[0]] <= 2 * PartialHashSize)
+		{
+			DuplicateGroups.Add(MoveTemp(Group.Value));
+		}
+		else
+		{
+			FullHashCandidates.Append(Group.Value);
+		}
+	}
+
+	// Pass 3: full content, only for real candidates
+	TArray<FString> FullHashes;
+	FullHashes.SetNum(FullHashCandidates.Num());
+
+	ParallelFileWork::ForEach(FullHashCandidates.Num(), MaxConcurrency, [&](int32 CandidateIndex)
+	{
+		FullHashes[CandidateIndex] = HashFile(Files[FullHashCandidates[CandidateIndex]], EFileHashType::XxHash3);
+	});
+
+	for (TPair<FString, TArray<int32>>& Group : GroupByHash(FullHashCandidates, FullHashes))
+	{
+		if (Group.Value.Num() > 1)
+		{
+			DuplicateGroups.Add(MoveTemp(Group.Value));
+		}
+	}
+
+	// Biggest savings first
+	DuplicateGroups.Sort([&Sizes](const TArray<int32>& A, const TArray<int32>& B)
+	{
+		return Sizes[A[0]] > Sizes[B[0]];
+	});
+
+	for (const TArray<int32>& Group : DuplicateGroups)
+	{
+		TArray<FString>& GroupFiles = OutGroups.AddDefaulted_GetRef();
+		for (int32 Index : Group)
+		{
+			GroupFiles.Add(Files[Index]);
+		}
+		OutFileSizes.Add(Sizes[Group[0]]);
+	}
+}
@@ -0,0 +1,372 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "FileNameIndex.h"
+#include "DirectoryWalkManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	// Fuzzy candidates have to share at least this fraction of the query's trigrams
+	const float MinFuzzyOverlap = 0.34f;
+}
+
+void FileNameIndex::GetTrigrams(const FString& LowerText, TArray<uint64>& OutTrigrams)
+{
+	OutTrigrams.Reset();
+
+	for (int32 Index = 0; Index + 2 < LowerText.Len(); Index++)
+	{
+		OutTrigrams.Add(uint64(uint16(LowerText[Index])) | (uint64(uint16(LowerText[Index + 1])) << 16) | (uint64(uint16(LowerText[Index + 2])) << 32));
+	}
+
+	OutTrigrams.Sort();
+	for (int32 Index = OutTrigrams.Num() - 1; Index > 0; Index--)
+	{
+		if (OutTrigrams[Index] == OutTrigrams[Index - 1])
+		{
+			OutTrigrams.RemoveAt(Index, 1, EAllowShrinking::No);
+		}
+	}
+}
+
+bool FileNameIndex::Build(const FString& PathToDirectory, int32 MaxConcurrency)
+{
+	uint64 BuildId;
+	int32 FirstPendingChange;
+	{
+		FWriteScopeLock WriteLock(Lock);
+		BuildId = ++NumBuildsStarted;
+		FirstPendingChange = PendingChanges.Num();
+		NumBuildsInFlight++;
+	}
+
+	// Walk without holding the lock, searches keep answering from the old content meanwhile
+	TArray<FString> Files;
+	const bool bRead = DirectoryWalkManager::Get().FindFiles(Files, PathToDirectory, FString(), true, MaxConcurrency);
+
+	FWriteScopeLock WriteLock(Lock);
+
+	// A build that started later already replaced the content with a newer walk
+	if (bRead && BuildId > LastBuildApplied)
+	{
+		ApplyBuildLocked(PathToDirectory, Files, FirstPendingChange);
+		LastBuildApplied = BuildId;
+	}
+
+	// The updates recorded since a walk started are only needed until the last build in flight is done
+	if (--NumBuildsInFlight == 0)
+	{
+		PendingChanges.Reset();
+	}
+	return bRead;
+}
+
+void FileNameIndex::ApplyBuildLocked(const FString& PathToDirectory, const TArray<FString>& Files, int32 FirstPendingChange)
+{
+	RootPath = PathToDirectory;
+	FPaths::NormalizeDirectoryName(RootPath);
+
+	Paths.Reset();
+	LowerNames.Reset();
+	NumTrigrams.Reset();
+	Alive.Reset();
+	PathIds.Reset();
+	Postings.Reset();
+	NumRemoved = 0;
+
+	for (const FString& File : Files)
+	{
+		AddFileLocked(File);
+	}
+
+	// The walk may or may not have seen these, replaying them in order gives the same result either way
+	for (int32 Index = FirstPendingChange; Index < PendingChanges.Num(); Index++)
+	{
+		const FPendingChange& Change = PendingChanges[Index];
+		if (Change.bAdded)
+		{
+			AddFileLocked(Change.Path);
+		}
+		else if (Change.bDirectory)
+		{
+			RemoveDirectoryLocked(Change.Path);
+		}
+		else
+		{
+			RemoveFileLocked(Change.Path);
+		}
+	}
+}
+
+void FileNameIndex::RecordPendingLocked(const FString& Path, bool bAdded, bool bDirectory)
+{
+	if (NumBuildsInFlight > 0)
+	{
+		PendingChanges.Add(FPendingChange{ Path, bAdded, bDirectory });
+	}
+}
+
+void FileNameIndex::AddFileLocked(const FString& Path)
+{
+	if (PathIds.Contains(Path))
+	{
+		return;
+	}
+
+	const int32 Id = Paths.Add(Path);
+	LowerNames.Add(FPaths::GetCleanFilename(Path).ToLower());
+	Alive.Add(true);
+	PathIds.Add(Path, Id);
+
+	TArray<uint64> Trigrams;
+	GetTrigrams(LowerNames[Id], Trigrams);
+	NumTrigrams.Add(uint16(FMath::Min(Trigrams.Num(), int32(MAX_uint16))));
+
+	// Ids only grow, so appending keeps every posting list sorted
+	for (uint64 Trigram : Trigrams)
+	{
+		Postings.FindOrAdd(Trigram).Add(Id);
+	}
+}
+
+void FileNameIndex::RemoveFileLocked(const FString& Path)
+{
+	int32 Id;
+	if (!PathIds.RemoveAndCopyValue(Path, Id))
+	{
+		return;
+	}
+
+	// Postings still reference the id, searches skip entries that aren't alive
+	Alive[Id] = false;
+	NumRemoved++;
+
+	if (NumRemoved > Paths.Num() / 2)
+	{
+		CompactLocked();
+	}
+}
+
+void FileNameIndex::CompactLocked()
+{
+	TArray<FString> AlivePaths;
+	AlivePaths.Reserve(Paths.Num() - NumRemoved);
+	for (int32 Id = 0; Id < Paths.Num(); Id++)
+	{
+		if (Alive[Id])
+		{
+			AlivePaths.Add(MoveTemp(Paths[Id]));
+		}
+	}
+
+	Paths.Reset();
+	LowerNames.Reset();
+	NumTrigrams.Reset();
+	Alive.Reset();
+	PathIds.Reset();
+	Postings.Reset();
+	NumRemoved = 0;
+
+	for (const FString& Path : AlivePaths)
+	{
+		AddFileLocked(Path);
+	}
+}
+
+void FileNameIndex::AddFile(const FString& Path)
+{
+	FWriteScopeLock WriteLock(Lock);
+	RecordPendingLocked(Path, true, false);
+	AddFileLocked(Path);
+}
+
+void FileNameIndex::RemoveFile(const FString& Path)
+{
+	FWriteScopeLock WriteLock(Lock);
+	RecordPendingLocked(Path, false, false);
+	RemoveFileLocked(Path);
+}
+
+void FileNameIndex::AddDirectory(const FString& PathToDirectory)
+{
+	TArray<FString> Files;
+	DirectoryWalkManager::Get().FindFiles(Files, PathToDirectory, FString(), true);
+
+	FWriteScopeLock WriteLock(Lock);
+	for (const FString& File : Files)
+	{
+		RecordPendingLocked(File, true, false);
+		AddFileLocked(File);
+	}
+}
+
+void FileNameIndex::RemoveDirectory(const FString& PathToDirectory)
+{
+	FString Prefix = PathToDirectory;
+	FPaths::NormalizeDirectoryName(Prefix);
+	Prefix /= TEXT("");
+
+	FWriteScopeLock WriteLock(Lock);
+	RecordPendingLocked(Prefix, false, true);
+	RemoveDirectoryLocked(Prefix);
+}
+
+void FileNameIndex::RemoveDirectoryLocked(const FString& Prefix)
+{
+	TArray<FString> Removed;
+	for (const TPair<FString, int32>& Entry : PathIds)
+	{
+		if (Entry.Key.StartsWith(Prefix))
+		{
+			Removed.Add(Entry.Key);
+		}
+	}
+
+	for (const FString& Path : Removed)
+	{
+		RemoveFileLocked(Path);
+	}
+}
+
+FString FileNameIndex::GetRootPath() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return RootPath;
+}
+
+int32 FileNameIndex::Num() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Paths.Num() - NumRemoved;
+}
+
+void FileNameIndex::SearchSubstring(const FString& Query, int32 MaxResults, TArray<FString>& OutPaths) const
+{
+	OutPaths.Reset();
+
+	const FString LowerQuery = Query.ToLower();
+	if (LowerQuery.IsEmpty() || MaxResults <= 0)
+	{
+		return;
+	}
+
+	FReadScopeLock ReadLock(Lock);
+
+	auto TryAdd = [this, &LowerQuery, &OutPaths](int32 Id)
+	{
+		if (Alive[Id] && LowerNames[Id].Contains(LowerQuery, ESearchCase::CaseSensitive))
+		{
+			OutPaths.Add(Paths[Id]);
+		}
+	};
+
+	TArray<uint64> Trigrams;
+	GetTrigrams(LowerQuery, Trigrams);
+
+	// Too short to have a trigram, a plain scan of the names is all we can do
+	if (Trigrams.Num() == 0)
+	{
+		for (int32 Id = 0; Id < Paths.Num() && OutPaths.Num() < MaxResults; Id++)
+		{
+			TryAdd(Id);
+		}
+		return;
+	}
+
+	// Intersect the posting lists, shortest first so the candidate set is small from the start
+	TArray<const TArray<int32>*> Lists;
+	for (uint64 Trigram : Trigrams)
+	{
+		const TArray<int32>* List = Postings.Find(Trigram);
+		if (!List)
+		{
+			return;
+		}
+		Lists.Add(List);
+	}
+	Lists.Sort([](const TArray<int32>& A, const TArray<int32>& B) { return A.Num() < B.Num(); });
+
+	TArray<int32> Candidates = *Lists[0];
+	for (int32 ListIndex = 1; ListIndex < Lists.Num() && Candidates.Num() > 0; ListIndex++)
+	{
+		const TArray<int32>& List = *Lists[ListIndex];
+		int32 Write = 0;
+		int32 Other = 0;
+		for (int32 Read = 0; Read < Candidates.Num(); Read++)
+		{
+			while (Other < List.Num() && List[Other] < Candidates[Read])
+			{
+				Other++;
+			}
+			if (Other < List.Num() && List[Other] == Candidates[Read])
+			{
+				Candidates[Write++] = Candidates[Read];
+			}
+		}
+		Candidates.SetNum(Write, EAllowShrinking::No);
+	}
+
+	// Sharing every trigram doesn't mean they are in order, check the actual substring
+	for (int32 Index = 0; Index < Candidates.Num() && OutPaths.Num() < MaxResults; Index++)
+	{
+		TryAdd(Candidates[Index]);
+	}
+}
+
+void FileNameIndex::SearchFuzzy(const FString& Query, int32 MaxResults, TArray<FString>& OutPaths) const
+{
+	OutPaths.Reset();
+
+	TArray<uint64> Trigrams;
+	GetTrigrams(Query.ToLower(), Trigrams);
+
+	if (Trigrams.Num() == 0)
+	{
+		SearchSubstring(Query, MaxResults, OutPaths);
+		return;
+	}
+	if (MaxResults <= 0)
+	{
+		return;
+	}
+
+	FReadScopeLock ReadLock(Lock);
+
+	// Count how many of the query's trigrams every name shares
+	TMap<int32, int32> SharedCounts;
+	for (uint64 Trigram : Trigrams)
+	{
+		if (const TArray<int32>* List = Postings.Find(Trigram))
+		{
+			for (int32 Id : *List)
+			{
+				SharedCounts.FindOrAdd(Id)++;
+			}
+		}
+	}
+
+	const int32 MinShared = FMath::Max(1, FMath::CeilToInt(Trigrams.Num() * MinFuzzyOverlap));
+
+	// Dice coefficient, so long names sharing a few trigrams by chance don't win over a close short one
+	TArray<TPair<float, int32>> Scored;
+	for (const TPair<int32, int32>& Shared : SharedCounts)
+	{
+		if (Shared.Value >= MinShared && Alive[Shared.Key])
+		{
+			const float Score = 2.f * Shared.Value / float(Trigrams.Num() + NumTrigrams[Shared.Key]);
+			Scored.Emplace(Score, Shared.Key);
+		}
+	}
+
+	Scored.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B)
+	{
+		return A.Key != B.Key ? A.Key > B.Key : A.Value < B.Value;
+	});
+
+	for (int32 Index = 0; Index < Scored.Num() && Index < MaxResults; Index++)
+	{
+		OutPaths.Add(Paths[Scored[Index].Value]);
+	}
+}
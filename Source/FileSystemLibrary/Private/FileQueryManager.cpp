@@ -0,0 +1,142 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "FileQueryManager.h"
+#include "DirectoryWalkManager.h"
+#include "FileFilter.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include <atomic>
+
+namespace
+{
+	/** Whether A ranks before B in the final order. */
+	bool RanksBefore(const FFileQueryEntry& A, const FFileQueryEntry& B, EFileSortKey SortKey, bool bDescending)
+	{
+		int32 Compare = 0;
+		switch (SortKey)
+		{
+		case EFileSortKey::Size:
+			Compare = A.Size == B.Size ? 0 : (A.Size < B.Size ? -1 : 1);
+			break;
+		case EFileSortKey::ModificationTime:
+			Compare = A.ModificationTime == B.ModificationTime ? 0 : (A.ModificationTime < B.ModificationTime ? -1 : 1);
+			break;
+		default:
+			Compare = A.Path.Compare(B.Path, ESearchCase::IgnoreCase);
+			break;
+		}
+
+		if (Compare == 0)
+		{
+			return A.Path.Compare(B.Path, ESearchCase::CaseSensitive) < 0;
+		}
+		return bDescending ? Compare > 0 : Compare < 0;
+	}
+}
+
+bool FileQueryManager::Query(const FString& PathToDirectory, const FileFilter& Filter, bool bRecursive, EFileSortKey SortKey, bool bDescending, int32 Offset, int32 Limit, int32 MaxConcurrency, TArray<FFileQueryEntry>& OutEntries, int64& OutTotalMatches)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	OutEntries.Reset();
+	OutTotalMatches = 0;
+
+	// A limit of 0 or less returns everything from Offset on, which is the only case that isn't bounded
+	Offset = FMath::Max(Offset, 0);
+	const int32 KeepCount = Limit > 0 ? (int32)FMath::Min<int64>(int64(Offset) + Limit, MAX_int32) : MAX_int32;
+
+	// Heap ordered so its top is the worst file kept, a new file only gets in by beating it
+	auto WorseFirst = [SortKey, bDescending](const FFileQueryEntry& A, const FFileQueryEntry& B)
+	{
+		return RanksBefore(B, A, SortKey, bDescending);
+	};
+
+	const int32 NumWorkers = bRecursive ? DirectoryWalkManager::GetNumWorkers(MaxConcurrency) : 1;
+	TArray<TArray<FFileQueryEntry>> WorkerHeaps;
+	WorkerHeaps.SetNum(NumWorkers);
+	std::atomic<int64> TotalMatches(0);
+
+	const bool bNeedsStat = SortKey != EFileSortKey::Name;
+
+	const bool bRead = DirectoryWalkManager::Get().Walk(PathToDirectory, bRecursive, NumWorkers, [&](int32 WorkerIndex, const FString& Directory, const TCHAR* Name, bool bIsDirectory)
+	{
+		if (bIsDirectory)
+		{
+			return Filter.ShouldEnterDirectory(Directory, Name);
+		}
+
+		if (!Filter.MatchesName(Directory, Name))
+		{
+			return true;
+		}
+
+		// Candidates are built in a reused per-thread entry, only files that make it into the heap allocate their own path
+		static thread_local FFileQueryEntry Candidate;
+		Candidate.Path.Reset();
+		Candidate.Path.Append(Directory);
+		Candidate.Path.AppendChar(TEXT('/'));
+		Candidate.Path.Append(Name);
+
+		// Without a stat these stay unset, never carry them over from a previous file or query
+		Candidate.Size = 0;
+		Candidate.ModificationTime = FDateTime::MinValue();
+
+		if (bNeedsStat || Filter.NeedsStat())
+		{
+			const FFileStatData StatData = PlatformFile.GetStatData(*Candidate.Path);
+			if (!StatData.bIsValid || (Filter.NeedsStat() && !Filter.MatchesStat(StatData.FileSize, StatData.ModificationTime)))
+			{
+				return true;
+			}
+			Candidate.Size = StatData.FileSize;
+			Candidate.ModificationTime = StatData.ModificationTime;
+		}
+
+		TotalMatches++;
+
+		TArray<FFileQueryEntry>& Heap = WorkerHeaps[WorkerIndex];
+		if (Heap.Num() < KeepCount)
+		{
+			Heap.HeapPush(Candidate, WorseFirst);
+		}
+		else if (RanksBefore(Candidate, Heap.HeapTop(), SortKey, bDescending))
+		{
+			Heap.HeapPopDiscard(WorseFirst, EAllowShrinking::No);
+			Heap.HeapPush(Candidate, WorseFirst);
+		}
+		return true;
+	});
+
+	// Merge the worker heaps into one of the same bound
+	TArray<FFileQueryEntry> Heap;
+	for (TArray<FFileQueryEntry>& WorkerHeap : WorkerHeaps)
+	{
+		for (FFileQueryEntry& Entry : WorkerHeap)
+		{
+			if (Heap.Num() < KeepCount)
+			{
+				Heap.HeapPush(MoveTemp(Entry), WorseFirst);
+			}
+			else if (RanksBefore(Entry, Heap.HeapTop(), SortKey, bDescending))
+			{
+				Heap.HeapPopDiscard(WorseFirst, EAllowShrinking::No);
+				Heap.HeapPush(MoveTemp(Entry), WorseFirst);
+			}
+		}
+		WorkerHeap.Empty();
+	}
+
+	// Only the kept files are sorted, then the requested page is cut out
+	Heap.Sort([SortKey, bDescending](const FFileQueryEntry& A, const FFileQueryEntry& B)
+	{
+		return RanksBefore(A, B, SortKey, bDescending);
+	});
+
+	for (int32 Index = Offset; Index < Heap.Num(); Index++)
+	{
+		OutEntries.Add(MoveTemp(Heap[Index]));
+	}
+
+	OutTotalMatches = TotalMatches;
+	return bRead;
+}
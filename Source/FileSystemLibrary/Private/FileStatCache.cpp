@@ -0,0 +1,188 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "FileStatCache.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
+#include <atomic>
+
+namespace
+{
+	// Hard cap so a walk over a huge tree can't grow the cache without bound, the cache is simply emptied when it is reached
+	const int32 MaxCachedPaths = 256 * 1024;
+
+	struct FCachedStat
+	{
+		FFileStatData StatData;
+		double Time;
+	};
+
+#if PLATFORM_LINUX
+	// Linux file systems are case sensitive, FString keys are not by default
+	struct FCaseSensitivePathKeyFuncs : TDefaultMapKeyFuncs<FString, FCachedStat, false>
+	{
+		static bool Matches(const FString& A, const FString& B)
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+
+		static uint32 GetKeyHash(const FString& Key)
+		{
+			return FCrc::StrCrc32(*Key);
+		}
+	};
+	typedef TMap<FString, FCachedStat, FDefaultSetAllocator, FCaseSensitivePathKeyFuncs> FStatMap;
+#else
+	typedef TMap<FString, FCachedStat> FStatMap;
+#endif
+
+	FRWLock CacheLock;
+	FStatMap Cache;
+	std::atomic<bool> bCacheEnabled(false);
+	std::atomic<double> CacheTimeToLive(1.0);
+	std::atomic<int64> Hits(0);
+	std::atomic<int64> Misses(0);
+
+	// Bumped by every invalidation, a stat that started before one may be stale and is not cached
+	std::atomic<uint64> InvalidationGeneration(0);
+
+	FString MakeKey(const FString& Path)
+	{
+		FString Key = Path;
+		FPaths::NormalizeDirectoryName(Key);
+		return Key;
+	}
+}
+
+void FileStatCache::SetEnabled(bool bEnabled, double TimeToLiveSeconds)
+{
+	bCacheEnabled = bEnabled;
+	CacheTimeToLive = FMath::Max(TimeToLiveSeconds, 0.0);
+
+	if (!bEnabled)
+	{
+		Clear();
+	}
+}
+
+bool FileStatCache::IsEnabled()
+{
+	return bCacheEnabled;
+}
+
+FFileStatData FileStatCache::GetStatData(const FString& Path)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!bCacheEnabled)
+	{
+		return PlatformFile.GetStatData(*Path);
+	}
+
+	const FString Key = MakeKey(Path);
+	const double Now = FPlatformTime::Seconds();
+	const uint64 Generation = InvalidationGeneration;
+
+	{
+		FReadScopeLock ReadLock(CacheLock);
+		const FCachedStat* Cached = Cache.Find(Key);
+		if (Cached && Now - Cached->Time <= CacheTimeToLive)
+		{
+			Hits++;
+			return Cached->StatData;
+		}
+	}
+
+	Misses++;
+
+	// Stat outside of the lock, the generation check below keeps an invalidation made meanwhile from being overwritten
+	const FFileStatData StatData = PlatformFile.GetStatData(*Path);
+
+	FWriteScopeLock WriteLock(CacheLock);
+	if (Generation != InvalidationGeneration)
+	{
+		return StatData;
+	}
+
+	if (Cache.Num() >= MaxCachedPaths)
+	{
+		Cache.Reset();
+	}
+	Cache.Add(Key, FCachedStat{ StatData, Now });
+
+	return StatData;
+}
+
+void FileStatCache::Invalidate(const FString& Path)
+{
+	if (!bCacheEnabled)
+	{
+		return;
+	}
+
+	FWriteScopeLock WriteLock(CacheLock);
+	InvalidationGeneration++;
+	Cache.Remove(MakeKey(Path));
+}
+
+void FileStatCache::InvalidatePathAndParents(const FString& Path)
+{
+	if (!bCacheEnabled)
+	{
+		return;
+	}
+
+	FWriteScopeLock WriteLock(CacheLock);
+	InvalidationGeneration++;
+	for (FString Key = MakeKey(Path); !Key.IsEmpty(); )
+	{
+		Cache.Remove(Key);
+
+		const FString Parent = FPaths::GetPath(Key);
+		if (Parent == Key)
+		{
+			break;
+		}
+		Key = Parent;
+	}
+}
+
+void FileStatCache::InvalidateDirectory(const FString& PathToDirectory)
+{
+	if (!bCacheEnabled)
+	{
+		return;
+	}
+
+	const FString Key = MakeKey(PathToDirectory);
+	const FString ChildPrefix = Key / TEXT("");
+
+	FWriteScopeLock WriteLock(CacheLock);
+	InvalidationGeneration++;
+	for (auto It = Cache.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Equals(Key, ESearchCase::CaseSensitive) || It.Key().StartsWith(ChildPrefix, ESearchCase::CaseSensitive))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FileStatCache::Clear()
+{
+	FWriteScopeLock WriteLock(CacheLock);
+	InvalidationGeneration++;
+	Cache.Reset();
+}
+
+void FileStatCache::GetCounters(int64& OutHits, int64& OutMisses)
+{
+	OutHits = Hits;
+	OutMisses = Misses;
+}
+
+void FileStatCache::ResetCounters()
+{
+	Hits = 0;
+	Misses = 0;
+}
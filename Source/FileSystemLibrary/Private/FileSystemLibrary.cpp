@@ -2,6 +2,10 @@
 // Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
 
 #include "FileSystemLibrary.h"
+#include "DirectoryGraveyard.h"
+#include "FileAppendManager.h"
+#include "MappedTextFile.h"
+#include "ParallelFileWork.h"
 
 #define LOCTEXT_NAMESPACE "FFileSystemLibraryModule"
 
@@ -9,6 +13,11 @@ void FFileSystemLibraryModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
 	
+	// Finish deleting directories a previous session buried but didn't get to purge
+	DirectoryGraveyard::PurgeLeftovers();
+
+	// Line indexes are rebuilt on demand, those of files that changed would only take up space
+	MappedTextFile::PurgeStaleLineIndexes();
 }
 
 void FFileSystemLibraryModule::ShutdownModule()
@@ -16,6 +25,12 @@ void FFileSystemLibraryModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 	
+	// Write the lines still queued for buffered appends
+	FileAppendManager::Shutdown();
+
+	DirectoryGraveyard::Shutdown();
+
+	ParallelFileWork::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
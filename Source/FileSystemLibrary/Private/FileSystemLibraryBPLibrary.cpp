@@ -4,6 +4,8 @@
 #include "FileSystemLibraryBPLibrary.h"
 #include "FileSystemLibrary.h"
 #include "TimerManager.h"
+#include "Async/Async.h"
+#include "Misc/ScopeLock.h"
 
 UFileSystemLibraryBPLibrary::UFileSystemLibraryBPLibrary(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
@@ -52,3 +54,637 @@ void UCreateProcessWithCallback::bIsProcessRunning()
 	}
 	
 }
+
+
+UCopyFileAsync* UCopyFileAsync::CopyFileAsync(UObject* WorldContextObj, FString PathToFile, FString DestinationFilePath, int ChunkSizeMB, float ProgressInterval)
+{
+	auto* AsyncAction = NewObject<UCopyFileAsync>();
+	AsyncAction->PathToFile = PathToFile;
+	AsyncAction->DestinationFilePath = DestinationFilePath;
+	AsyncAction->ChunkSize = FMath::Max(ChunkSizeMB, 1) * int64(1024 * 1024);
+	AsyncAction->ProgressInterval = FMath::Max(ProgressInterval, 0.f);
+	AsyncAction->CancelFlag = MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+	AsyncAction->RegisterWithGameInstance(WorldContextObj);
+	return AsyncAction;
+}
+
+void UCopyFileAsync::Cancel()
+{
+	*CancelFlag = true;
+}
+
+void UCopyFileAsync::Activate()
+{
+	Super::Activate();
+
+	TWeakObjectPtr<UCopyFileAsync> WeakThis(this);
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> Cancel = CancelFlag;
+	const FString From = PathToFile;
+	const FString To = DestinationFilePath;
+	const int64 Chunk = ChunkSize;
+	const double Interval = ProgressInterval;
+
+	Async(EAsyncExecution::Thread, [WeakThis, Cancel, From, To, Chunk, Interval]()
+	{
+		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		int64 TotalBytes = PlatformFile.FileSize(*From);
+		int64 BytesCopied = 0;
+		double LastProgressTime = 0.0;
+
+		// Only hop to the game thread once per interval, not once per chunk
+		auto OnProgress = [WeakThis, Interval, &BytesCopied, &LastProgressTime](int64 InBytesCopied, int64 InTotalBytes)
+		{
+			BytesCopied = InBytesCopied;
+
+			const double Now = FPlatformTime::Seconds();
+			if (Now - LastProgressTime >= Interval)
+			{
+				LastProgressTime = Now;
+				AsyncTask(ENamedThreads::GameThread, [WeakThis, InBytesCopied, InTotalBytes]()
+				{
+					if (UCopyFileAsync* This = WeakThis.Get())
+					{
+						This->Progress.Broadcast(InBytesCopied, InTotalBytes);
+					}
+				});
+			}
+		};
+
+		EFileCopyResult Result = EFileCopyResult::Failed;
+		if (TotalBytes >= 0)
+		{
+			Result = FileCopyManager::Get().CopyFile(From, To, Cancel.Get(), OnProgress, Chunk);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Result, BytesCopied, TotalBytes]()
+		{
+			if (UCopyFileAsync* This = WeakThis.Get())
+			{
+				This->OnCopyFinished(Result, BytesCopied, TotalBytes);
+			}
+		});
+	});
+}
+
+void UCopyFileAsync::OnCopyFinished(EFileCopyResult Result, int64 BytesCopied, int64 TotalBytes)
+{
+	if (Result == EFileCopyResult::Success)
+	{
+		Progress.Broadcast(TotalBytes, TotalBytes);
+		Completed.Broadcast(TotalBytes, TotalBytes);
+	}
+	else
+	{
+		Failed.Broadcast(BytesCopied, FMath::Max<int64>(TotalBytes, 0));
+	}
+
+	SetReadyToDestroy();
+}
+
+/** Backpressure between a worker thread producing batches and the game thread broadcasting them. */
+struct FAsyncBatchState
+{
+	FThreadSafeBool bCancelled;
+	std::atomic<int32> BatchesInFlight;
+	int32 MaxBatchesInFlight;
+	FEvent* BatchConsumed;
+
+	explicit FAsyncBatchState(int32 InMaxBatchesInFlight)
+		: BatchesInFlight(0)
+		, MaxBatchesInFlight(FMath::Max(InMaxBatchesInFlight, 1))
+		, BatchConsumed(FPlatformProcess::GetSynchEventFromPool(false))
+	{
+	}
+
+	~FAsyncBatchState()
+	{
+		FPlatformProcess::ReturnSynchEventToPool(BatchConsumed);
+	}
+
+	/** Called by the producer before sending a batch, waits while too many are queued. Returns false once cancelled. */
+	bool WaitForRoom()
+	{
+		while (BatchesInFlight >= MaxBatchesInFlight && !bCancelled)
+		{
+			BatchConsumed->Wait(100);
+		}
+
+		if (bCancelled)
+		{
+			return false;
+		}
+
+		BatchesInFlight++;
+		return true;
+	}
+
+	/** Called on the game thread once a batch has been broadcast (or dropped). */
+	void OnBatchConsumed()
+	{
+		BatchesInFlight--;
+		BatchConsumed->Trigger();
+	}
+
+	void Cancel()
+	{
+		bCancelled = true;
+		BatchConsumed->Trigger();
+	}
+};
+
+UEnumerateDirectoryAsync* UEnumerateDirectoryAsync::EnumerateDirectoryAsync(UObject* WorldContextObj, FString PathToDirectory, FString ExtensionFilter, bool OnlyReturnFilenames, bool Recursive, int BatchSize, int MaxBatchesInFlight)
+{
+	auto* AsyncAction = NewObject<UEnumerateDirectoryAsync>();
+	AsyncAction->PathToDirectory = PathToDirectory;
+	AsyncAction->ExtensionFilter = ExtensionFilter;
+	AsyncAction->bOnlyReturnFilenames = OnlyReturnFilenames;
+	AsyncAction->bRecursive = Recursive;
+	AsyncAction->BatchSize = FMath::Max(BatchSize, 1);
+	AsyncAction->State = MakeShared<FAsyncBatchState, ESPMode::ThreadSafe>(MaxBatchesInFlight);
+	AsyncAction->RegisterWithGameInstance(WorldContextObj);
+	return AsyncAction;
+}
+
+void UEnumerateDirectoryAsync::Cancel()
+{
+	State->Cancel();
+}
+
+void UEnumerateDirectoryAsync::Activate()
+{
+	Super::Activate();
+
+	TWeakObjectPtr<UEnumerateDirectoryAsync> WeakThis(this);
+	TSharedPtr<FAsyncBatchState, ESPMode::ThreadSafe> SharedState = State;
+	DirectoryEnumerator Enumerator(PathToDirectory, ExtensionFilter, bRecursive, BatchSize, bOnlyReturnFilenames);
+
+	Async(EAsyncExecution::Thread, [WeakThis, SharedState, Enumerator = MoveTemp(Enumerator)]() mutable
+	{
+		int64 FilesFound = 0;
+		TArray<FString> Files;
+
+		while (!SharedState->bCancelled && Enumerator.NextBatch(Files))
+		{
+			FilesFound += Files.Num();
+
+			// Backpressure, don't walk further ahead than the game thread can keep up with
+			if (!SharedState->WaitForRoom())
+			{
+				break;
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, SharedState, Files = MoveTemp(Files), FilesFound]()
+			{
+				UEnumerateDirectoryAsync* This = WeakThis.Get();
+				if (This && !SharedState->bCancelled)
+				{
+					This->Batch.Broadcast(Files, FilesFound);
+				}
+				else
+				{
+					// Nobody is listening anymore
+					SharedState->Cancel();
+				}
+
+				SharedState->OnBatchConsumed();
+			});
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, SharedState, FilesFound]()
+		{
+			if (UEnumerateDirectoryAsync* This = WeakThis.Get())
+			{
+				if (!SharedState->bCancelled)
+				{
+					This->Completed.Broadcast(TArray<FString>(), FilesFound);
+				}
+				This->SetReadyToDestroy();
+			}
+		});
+	});
+}
+
+UDirectoryWatcher* UDirectoryWatcher::WatchDirectory(FString PathToDirectory, bool Recursive, float DebounceSeconds)
+{
+	auto* Watcher = NewObject<UDirectoryWatcher>();
+	Watcher->WatchManager = DirectoryWatchManager::Create();
+
+	TWeakObjectPtr<UDirectoryWatcher> WeakWatcher(Watcher);
+	Watcher->bIsWatching = Watcher->WatchManager->StartWatching(PathToDirectory, Recursive, DebounceSeconds, [WeakWatcher](TArray<FDirectoryChange>&& Changes)
+	{
+		TArray<FDirectoryChangeEvent> Events;
+		Events.Reserve(Changes.Num());
+		for (const FDirectoryChange& Change : Changes)
+		{
+			Events.Emplace(Change);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakWatcher, Events = MoveTemp(Events)]()
+		{
+			UDirectoryWatcher* This = WeakWatcher.Get();
+			if (This && This->bIsWatching)
+			{
+				This->OnDirectoryChanged.Broadcast(Events);
+			}
+		});
+	});
+
+	return Watcher;
+}
+
+void UDirectoryWatcher::Stop()
+{
+	bIsWatching = false;
+	if (WatchManager)
+	{
+		WatchManager->StopWatching();
+	}
+}
+
+bool UDirectoryWatcher::IsWatching() const
+{
+	return bIsWatching;
+}
+
+void UDirectoryWatcher::BeginDestroy()
+{
+	Stop();
+	Super::BeginDestroy();
+}
+
+UFileIndex* UFileIndex::LoadFileIndex(FString PathToDirectory, FString IndexFilePath)
+{
+	auto* FileIndex = NewObject<UFileIndex>();
+	FileIndex->IndexFilePath = IndexFilePath;
+
+	FPaths::NormalizeDirectoryName(PathToDirectory);
+
+	if (FileIndex->Index.Load(IndexFilePath) && FileIndex->Index.GetRootPath() == PathToDirectory)
+	{
+		FileIndex->Refresh();
+	}
+	else
+	{
+		// An unreadable directory would otherwise be saved as an empty index, and overwrite a good one
+		if (!FileIndex->Index.Build(PathToDirectory))
+		{
+			return nullptr;
+		}
+		FileIndex->Index.Save(IndexFilePath);
+	}
+
+	return FileIndex;
+}
+
+bool UFileIndex::Refresh()
+{
+	if (!Index.Refresh())
+	{
+		return false;
+	}
+
+	Index.Save(IndexFilePath);
+	return true;
+}
+
+bool UFileIndex::Rebuild()
+{
+	return Index.Build(Index.GetRootPath()) && Index.Save(IndexFilePath);
+}
+
+TArray<FString> UFileIndex::GetFiles(const FString& ExtensionFilter) const
+{
+	TArray<FString> Files;
+	Files.Reserve(Index.GetNumFiles());
+	Index.GetFiles(Files, ExtensionFilter);
+	return Files;
+}
+
+int32 UFileIndex::GetNumFiles() const
+{
+	return Index.GetNumFiles();
+}
+
+UFileNameIndex* UFileNameIndex::BuildFileNameIndex(FString PathToDirectory, int MaxConcurrency)
+{
+	auto* NameIndex = NewObject<UFileNameIndex>();
+	NameIndex->MaxConcurrency = MaxConcurrency;
+	NameIndex->Index->Build(PathToDirectory, MaxConcurrency);
+	return NameIndex;
+}
+
+void UFileNameIndex::RebuildInBackground()
+{
+	TSharedPtr<FileNameIndex, ESPMode::ThreadSafe> SharedIndex = Index;
+	const int32 Concurrency = MaxConcurrency;
+	const FString RootPath = SharedIndex->GetRootPath();
+
+	Async(EAsyncExecution::Thread, [SharedIndex, Concurrency, RootPath]()
+	{
+		SharedIndex->Build(RootPath, Concurrency);
+	});
+}
+
+TArray<FString> UFileNameIndex::SearchSubstring(const FString& Query, int MaxResults) const
+{
+	TArray<FString> Results;
+	Index->SearchSubstring(Query, MaxResults, Results);
+	return Results;
+}
+
+TArray<FString> UFileNameIndex::SearchFuzzy(const FString& Query, int MaxResults) const
+{
+	TArray<FString> Results;
+	Index->SearchFuzzy(Query, MaxResults, Results);
+	return Results;
+}
+
+void UFileNameIndex::AddFile(const FString& Path)
+{
+	Index->AddFile(Path);
+}
+
+void UFileNameIndex::RemoveFile(const FString& Path)
+{
+	Index->RemoveFile(Path);
+}
+
+void UFileNameIndex::ApplyDirectoryChanges(const TArray<FDirectoryChangeEvent>& Changes)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	for (const FDirectoryChangeEvent& Change : Changes)
+	{
+		switch (Change.Change)
+		{
+		case EDirectoryChangeKind::Added:
+		case EDirectoryChangeKind::Renamed:
+			if (Change.Change == EDirectoryChangeKind::Renamed)
+			{
+				Index->RemoveFile(Change.OldPath);
+				Index->RemoveDirectory(Change.OldPath);
+			}
+
+			if (PlatformFile.DirectoryExists(*Change.Path))
+			{
+				Index->AddDirectory(Change.Path);
+			}
+			else
+			{
+				Index->AddFile(Change.Path);
+			}
+			break;
+
+		case EDirectoryChangeKind::Removed:
+			Index->RemoveFile(Change.Path);
+			Index->RemoveDirectory(Change.Path);
+			break;
+
+		case EDirectoryChangeKind::Overflow:
+			// Events were lost, only a new walk can tell what changed
+			RebuildInBackground();
+			return;
+
+		default:
+			break;
+		}
+	}
+}
+
+int32 UFileNameIndex::GetNumFiles() const
+{
+	return Index->Num();
+}
+
+USearchFileNameIndexAsync* USearchFileNameIndexAsync::SearchFileNameIndexAsync(UObject* WorldContextObj, UFileNameIndex* Index, FString Query, bool Fuzzy, int MaxResults)
+{
+	auto* AsyncAction = NewObject<USearchFileNameIndexAsync>();
+	AsyncAction->Index = Index ? Index->GetIndex() : nullptr;
+	AsyncAction->Query = Query;
+	AsyncAction->bFuzzy = Fuzzy;
+	AsyncAction->MaxResults = MaxResults;
+	AsyncAction->RegisterWithGameInstance(WorldContextObj);
+	return AsyncAction;
+}
+
+void USearchFileNameIndexAsync::Activate()
+{
+	Super::Activate();
+
+	TWeakObjectPtr<USearchFileNameIndexAsync> WeakThis(this);
+	TSharedPtr<FileNameIndex, ESPMode::ThreadSafe> SharedIndex = Index;
+	const FString SearchQuery = Query;
+	const bool bSearchFuzzy = bFuzzy;
+	const int32 Limit = MaxResults;
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, SharedIndex, SearchQuery, bSearchFuzzy, Limit]()
+	{
+		TArray<FString> Results;
+		if (SharedIndex.IsValid())
+		{
+			if (bSearchFuzzy)
+			{
+				SharedIndex->SearchFuzzy(SearchQuery, Limit, Results);
+			}
+			else
+			{
+				SharedIndex->SearchSubstring(SearchQuery, Limit, Results);
+			}
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Results = MoveTemp(Results)]()
+		{
+			if (USearchFileNameIndexAsync* This = WeakThis.Get())
+			{
+				This->Completed.Broadcast(Results);
+				This->SetReadyToDestroy();
+			}
+		});
+	});
+}
+
+UFindInFilesAsync* UFindInFilesAsync::FindInFilesAsync(UObject* WorldContextObj, FString PathToDirectory, FString Pattern, const FFileFilterSpec& Filter, bool Regex, bool CaseSensitive, int MaxHitsPerFile, int MaxConcurrency, float ReportInterval)
+{
+	auto* AsyncAction = NewObject<UFindInFilesAsync>();
+	AsyncAction->PathToDirectory = PathToDirectory;
+	AsyncAction->Pattern = Pattern;
+	AsyncAction->Filter = Filter;
+	AsyncAction->Options.bRegex = Regex;
+	AsyncAction->Options.bCaseSensitive = CaseSensitive;
+	AsyncAction->Options.MaxMatchesPerFile = FMath::Max(MaxHitsPerFile, 0);
+	AsyncAction->MaxConcurrency = MaxConcurrency;
+	AsyncAction->ReportInterval = FMath::Max(ReportInterval, 0.f);
+	AsyncAction->CancelFlag = MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+	AsyncAction->RegisterWithGameInstance(WorldContextObj);
+	return AsyncAction;
+}
+
+void UFindInFilesAsync::Cancel()
+{
+	*CancelFlag = true;
+}
+
+void UFindInFilesAsync::Activate()
+{
+	Super::Activate();
+
+	TWeakObjectPtr<UFindInFilesAsync> WeakThis(this);
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> Cancel = CancelFlag;
+	const FString Directory = PathToDirectory;
+	const FString SearchPattern = Pattern;
+	const FFileFilterRules Rules = Filter.ToRules();
+	const FContentSearchOptions SearchOptions = Options;
+	const int32 Concurrency = MaxConcurrency;
+	const double Interval = ReportInterval;
+
+	Async(EAsyncExecution::Thread, [WeakThis, Cancel, Directory, SearchPattern, Rules, SearchOptions, Concurrency, Interval]()
+	{
+		// Workers add their hits here, whoever finds the interval elapsed ships the batch to the game thread
+		FCriticalSection PendingLock;
+		TArray<FContentSearchHit> PendingHits;
+		int64 TotalHits = 0;
+		double LastReportTime = 0.0;
+
+		auto Report = [WeakThis, Cancel](TArray<FContentSearchHit>&& Hits, int64 InTotalHits)
+		{
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Cancel, Hits = MoveTemp(Hits), InTotalHits]()
+			{
+				UFindInFilesAsync* This = WeakThis.Get();
+				if (This && !*Cancel)
+				{
+					This->Found.Broadcast(Hits, InTotalHits);
+				}
+			});
+		};
+
+		const bool bSearched = ContentSearchManager::Search(Directory, FileFilter(Directory, Rules), SearchPattern, SearchOptions, Concurrency, Cancel.Get(), [&](TArray<FContentSearchMatch>&& Matches)
+		{
+			FScopeLock Lock(&PendingLock);
+
+			for (const FContentSearchMatch& Match : Matches)
+			{
+				PendingHits.Emplace(Match);
+			}
+			TotalHits += Matches.Num();
+
+			const double Now = FPlatformTime::Seconds();
+			if (Now - LastReportTime >= Interval)
+			{
+				LastReportTime = Now;
+				Report(MoveTemp(PendingHits), TotalHits);
+				PendingHits.Reset();
+			}
+		});
+
+		if (PendingHits.Num() > 0)
+		{
+			Report(MoveTemp(PendingHits), TotalHits);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Cancel, TotalHits, bSearched]()
+		{
+			if (UFindInFilesAsync* This = WeakThis.Get())
+			{
+				if (!*Cancel)
+				{
+					(bSearched ? This->Completed : This->Failed).Broadcast(TArray<FContentSearchHit>(), TotalHits);
+				}
+				This->SetReadyToDestroy();
+			}
+		});
+	});
+}
+
+UReadLinesAsync* UReadLinesAsync::ReadLinesAsync(UObject* WorldContextObj, FString PathToFile, int BatchSize, int MaxBatchesInFlight)
+{
+	auto* AsyncAction = NewObject<UReadLinesAsync>();
+	AsyncAction->PathToFile = PathToFile;
+	AsyncAction->BatchSize = FMath::Max(BatchSize, 1);
+	AsyncAction->State = MakeShared<FAsyncBatchState, ESPMode::ThreadSafe>(MaxBatchesInFlight);
+	AsyncAction->RegisterWithGameInstance(WorldContextObj);
+	return AsyncAction;
+}
+
+void UReadLinesAsync::Cancel()
+{
+	State->Cancel();
+}
+
+void UReadLinesAsync::Activate()
+{
+	Super::Activate();
+
+	TWeakObjectPtr<UReadLinesAsync> WeakThis(this);
+	TSharedPtr<FAsyncBatchState, ESPMode::ThreadSafe> SharedState = State;
+	FString Path = PathToFile;
+	const int32 LinesPerBatch = BatchSize;
+
+	Async(EAsyncExecution::Thread, [WeakThis, SharedState, Path, LinesPerBatch]()
+	{
+		LineStreamReader Reader;
+		if (!Reader.Open(Path))
+		{
+			AsyncTask(ENamedThreads::GameThread, [WeakThis]()
+			{
+				if (UReadLinesAsync* This = WeakThis.Get())
+				{
+					This->Failed.Broadcast(TArray<FString>(), 0);
+					This->SetReadyToDestroy();
+				}
+			});
+			return;
+		}
+
+		int64 LinesRead = 0;
+		TArray<FString> Lines;
+
+		while (!SharedState->bCancelled && Reader.ReadLines(Lines, LinesPerBatch))
+		{
+			LinesRead += Lines.Num();
+
+			// Backpressure, don't read further ahead than the game thread can keep up with
+			if (!SharedState->WaitForRoom())
+			{
+				break;
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, SharedState, Lines = MoveTemp(Lines), LinesRead]()
+			{
+				UReadLinesAsync* This = WeakThis.Get();
+				if (This && !SharedState->bCancelled)
+				{
+					This->Batch.Broadcast(Lines, LinesRead);
+				}
+				else
+				{
+					// Nobody is listening anymore
+					SharedState->Cancel();
+				}
+
+				SharedState->OnBatchConsumed();
+			});
+		}
+
+		const bool bReadError = Reader.HasReadError();
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, SharedState, LinesRead, bReadError]()
+		{
+			if (UReadLinesAsync* This = WeakThis.Get())
+			{
+				if (!SharedState->bCancelled)
+				{
+					// A read error mid-file would otherwise look like a shorter file
+					if (bReadError)
+					{
+						This->Failed.Broadcast(TArray<FString>(), LinesRead);
+					}
+					else
+					{
+						This->Completed.Broadcast(TArray<FString>(), LinesRead);
+					}
+				}
+				This->SetReadyToDestroy();
+			}
+		});
+	});
+}
@@ -0,0 +1,120 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "LineStreamReader.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include <string.h>
+
+LineStreamReader::LineStreamReader()
+{
+}
+
+LineStreamReader::~LineStreamReader()
+{
+}
+
+bool LineStreamReader::Open(const FString& PathToFile, int64 InChunkSize)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	Handle.Reset(PlatformFile.OpenRead(*PathToFile));
+	if (!Handle)
+	{
+		return false;
+	}
+
+	ChunkSize = FMath::Clamp<int64>(InChunkSize, 4096, MAX_int32 / 2);
+	FileSize = Handle->Size();
+	BytesRead = 0;
+	Buffer.Reset();
+	Consumed = 0;
+	bEndOfFile = false;
+	bReadError = false;
+
+	// Skip a UTF-8 BOM
+	if (ReadChunk() && Buffer.Num() >= 3 && Buffer[0] == 0xEF && Buffer[1] == 0xBB && Buffer[2] == 0xBF)
+	{
+		Consumed = 3;
+	}
+	return true;
+}
+
+bool LineStreamReader::ReadChunk()
+{
+	if (bEndOfFile || !Handle)
+	{
+		return false;
+	}
+
+	// Keep the partial line at the end of the buffer, it continues in the next chunk
+	const int32 Remaining = Buffer.Num() - Consumed;
+	if (Consumed > 0)
+	{
+		FMemory::Memmove(Buffer.GetData(), Buffer.GetData() + Consumed, Remaining);
+		Consumed = 0;
+	}
+
+	const int64 ToRead = FMath::Min(ChunkSize, FileSize - BytesRead);
+	if (ToRead <= 0)
+	{
+		Buffer.SetNum(Remaining, EAllowShrinking::No);
+		bEndOfFile = true;
+		return false;
+	}
+
+	Buffer.SetNumUninitialized(Remaining + int32(ToRead), EAllowShrinking::No);
+	if (!Handle->Read(Buffer.GetData() + Remaining, ToRead))
+	{
+		// The partial line left in the buffer is cut short, drop it rather than return it as the last line
+		Buffer.Reset();
+		Consumed = 0;
+		bEndOfFile = true;
+		bReadError = true;
+		return false;
+	}
+
+	BytesRead += ToRead;
+	return true;
+}
+
+bool LineStreamReader::ReadLines(TArray<FString>& OutLines, int32 MaxLines)
+{
+	OutLines.Reset();
+	MaxLines = FMath::Max(MaxLines, 1);
+
+	auto AddLine = [&OutLines](const uint8* Start, int32 Length)
+	{
+		if (Length > 0 && Start[Length - 1] == '\r')
+		{
+			Length--;
+		}
+		FUTF8ToTCHAR Converted((const ANSICHAR*)Start, Length);
+		OutLines.Emplace(Converted.Length(), Converted.Get());
+	};
+
+	while (OutLines.Num() < MaxLines)
+	{
+		const uint8* Start = Buffer.GetData() + Consumed;
+		const uint8* NewLine = (const uint8*)memchr(Start, '\n', Buffer.Num() - Consumed);
+
+		if (NewLine)
+		{
+			AddLine(Start, int32(NewLine - Start));
+			Consumed = int32(NewLine - Buffer.GetData()) + 1;
+			continue;
+		}
+
+		if (!ReadChunk())
+		{
+			// Last line without a line break
+			if (Consumed < Buffer.Num())
+			{
+				AddLine(Buffer.GetData() + Consumed, Buffer.Num() - Consumed);
+				Consumed = Buffer.Num();
+			}
+			break;
+		}
+	}
+
+	return OutLines.Num() > 0;
+}
@@ -0,0 +1,87 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for reading directories on the Linux platform straight from the kernel.
+
+#include "Linux/DirectoryWalkManagerLinux.h"
+
+#if PLATFORM_LINUX
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+namespace
+{
+	// Layout the kernel fills in, glibc only exposes it through readdir
+	struct FLinuxDirent64
+	{
+		uint64 d_ino;
+		int64 d_off;
+		unsigned short d_reclen;
+		unsigned char d_type;
+		char d_name[1];
+	};
+
+	// Big enough for thousands of entries per syscall, kept per thread so a walk doesn't allocate per directory
+	const int32 DirentBufferSize = 256 * 1024;
+}
+#endif
+
+bool DirectoryWalkManagerLinux::ReadDirectory(const FString& PathToDirectory, FEntryVisitor Visitor)
+{
+#if PLATFORM_LINUX
+	const int DirectoryFd = open(TCHAR_TO_UTF8(*PathToDirectory), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (DirectoryFd < 0)
+	{
+		return false;
+	}
+
+	static thread_local TArray<uint8> DirentBuffer;
+	if (DirentBuffer.Num() == 0)
+	{
+		DirentBuffer.SetNumUninitialized(DirentBufferSize);
+	}
+	uint8* Buffer = DirentBuffer.GetData();
+
+	bool bRead = true;
+	for (;;)
+	{
+		const long BytesRead = syscall(SYS_getdents64, DirectoryFd, Buffer, DirentBufferSize);
+		if (BytesRead <= 0)
+		{
+			// A failed read leaves the listing incomplete
+			bRead = BytesRead == 0;
+			break;
+		}
+
+		for (long Offset = 0; Offset < BytesRead;)
+		{
+			const FLinuxDirent64* Entry = reinterpret_cast<const FLinuxDirent64*>(Buffer + Offset);
+			Offset += Entry->d_reclen;
+
+			const char* Name = Entry->d_name;
+			if (Name[0] == '.' && (Name[1] == '\0' || (Name[1] == '.' && Name[2] == '\0')))
+			{
+				continue;
+			}
+
+			bool bIsDirectory = Entry->d_type == DT_DIR;
+
+			// Symlinks are followed like IterateDirectory does, and some file systems don't fill d_type at all
+			if (Entry->d_type == DT_LNK || Entry->d_type == DT_UNKNOWN)
+			{
+				struct stat StatData;
+				bIsDirectory = fstatat(DirectoryFd, Name, &StatData, 0) == 0 && S_ISDIR(StatData.st_mode);
+			}
+
+			Visitor(UTF8_TO_TCHAR(Name), bIsDirectory);
+		}
+	}
+
+	close(DirectoryFd);
+	return bRead;
+#else
+	return DirectoryWalkManager::ReadDirectory(PathToDirectory, Visitor);
+#endif
+}
@@ -0,0 +1,428 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for watching directories on the Linux platform with inotify.
+
+#include "Linux/DirectoryWatchManagerLinux.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/RunnableThread.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_LINUX
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+namespace
+{
+	const uint32 WatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR;
+
+	// Under constant churn a burst never goes quiet, deliver at least this many debounce windows apart
+	const double MaxLatencyInDebounces = 10.0;
+}
+#endif
+
+DirectoryWatchManagerLinux::~DirectoryWatchManagerLinux()
+{
+	StopWatching();
+}
+
+bool DirectoryWatchManagerLinux::StartWatching(const FString& PathToDirectory, bool bRecursive, double DebounceSeconds, FChangesCallback OnChanges)
+{
+#if PLATFORM_LINUX
+	StopWatching();
+
+	InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	WakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (InotifyFd < 0 || WakeFd < 0)
+	{
+		StopWatching();
+		return false;
+	}
+
+	RootPath = PathToDirectory;
+	FPaths::NormalizeDirectoryName(RootPath);
+	bWatchRecursively = bRecursive;
+	Debounce = FMath::Max(DebounceSeconds, 0.0);
+	ChangesCallback = MoveTemp(OnChanges);
+
+	AddWatch(RootPath, false);
+	if (WatchedDirectories.Num() == 0)
+	{
+		StopWatching();
+		return false;
+	}
+
+	bStopping = false;
+	Thread = FRunnableThread::Create(this, TEXT("FileSystemLibraryDirectoryWatcher"), 0, TPri_BelowNormal);
+	return Thread != nullptr;
+#else
+	return false;
+#endif
+}
+
+void DirectoryWatchManagerLinux::StopWatching()
+{
+#if PLATFORM_LINUX
+	if (Thread)
+	{
+		bStopping = true;
+
+		const uint64 Wake = 1;
+		write(WakeFd, &Wake, sizeof(Wake));
+
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	// Closing the inotify descriptor drops every watch
+	if (InotifyFd >= 0)
+	{
+		close(InotifyFd);
+		InotifyFd = -1;
+	}
+	if (WakeFd >= 0)
+	{
+		close(WakeFd);
+		WakeFd = -1;
+	}
+
+	WatchedDirectories.Reset();
+	PendingChanges.Reset();
+	PendingMoves.Reset();
+#endif
+}
+
+uint32 DirectoryWatchManagerLinux::Run()
+{
+#if PLATFORM_LINUX
+	auto GetFlushTime = [this]()
+	{
+		return FMath::Min(LastEventTime + Debounce, FirstPendingTime + Debounce * MaxLatencyInDebounces);
+	};
+
+	while (!bStopping)
+	{
+		// Sleep until an event arrives, or until the pending burst is due
+		const bool bHasPendingChanges = PendingChanges.Num() > 0 || PendingMoves.Num() > 0;
+		int Timeout = -1;
+		if (bHasPendingChanges)
+		{
+			Timeout = FMath::Max(0, FMath::CeilToInt((GetFlushTime() - FPlatformTime::Seconds()) * 1000.0));
+		}
+
+		pollfd PollFds[2];
+		PollFds[0].fd = InotifyFd;
+		PollFds[0].events = POLLIN;
+		PollFds[1].fd = WakeFd;
+		PollFds[1].events = POLLIN;
+
+		const int Ready = poll(PollFds, 2, Timeout);
+		if (Ready < 0 && errno != EINTR)
+		{
+			break;
+		}
+
+		if (Ready > 0 && (PollFds[0].revents & POLLIN))
+		{
+			ReadEvents();
+		}
+
+		if ((PendingChanges.Num() > 0 || PendingMoves.Num() > 0) && FPlatformTime::Seconds() >= GetFlushTime())
+		{
+			Flush();
+		}
+	}
+#endif
+	return 0;
+}
+
+void DirectoryWatchManagerLinux::AddWatch(const FString& Directory, bool bReportContents)
+{
+#if PLATFORM_LINUX
+	const int32 WatchDescriptor = inotify_add_watch(InotifyFd, TCHAR_TO_UTF8(*Directory), WatchMask);
+	if (WatchDescriptor < 0)
+	{
+		return;
+	}
+	WatchedDirectories.Add(WatchDescriptor, Directory);
+
+	if (!bWatchRecursively && !bReportContents)
+	{
+		return;
+	}
+
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.IterateDirectory(*Directory, [this, bReportContents](const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+	{
+		if (bReportContents)
+		{
+			RecordChange(FilenameOrDirectory, EDirectoryChangeType::Added);
+		}
+		if (bIsDirectory && bWatchRecursively)
+		{
+			AddWatch(FilenameOrDirectory, bReportContents);
+		}
+		return true;
+	});
+#endif
+}
+
+void DirectoryWatchManagerLinux::RemoveWatches(const FString& Directory)
+{
+#if PLATFORM_LINUX
+	const FString ChildPrefix = Directory / TEXT("");
+
+	for (auto It = WatchedDirectories.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Equals(Directory, ESearchCase::CaseSensitive) || It.Value().StartsWith(ChildPrefix, ESearchCase::CaseSensitive))
+		{
+			inotify_rm_watch(InotifyFd, It.Key());
+			It.RemoveCurrent();
+		}
+	}
+#endif
+}
+
+void DirectoryWatchManagerLinux::RenameWatches(const FString& OldDirectory, const FString& NewDirectory)
+{
+	// inotify watches follow the inode, only our path names are stale
+	const FString ChildPrefix = OldDirectory / TEXT("");
+
+	for (TPair<int32, FString>& Watch : WatchedDirectories)
+	{
+		if (Watch.Value.Equals(OldDirectory, ESearchCase::CaseSensitive))
+		{
+			Watch.Value = NewDirectory;
+		}
+		else if (Watch.Value.StartsWith(ChildPrefix, ESearchCase::CaseSensitive))
+		{
+			Watch.Value = NewDirectory / Watch.Value.RightChop(ChildPrefix.Len());
+		}
+	}
+}
+
+void DirectoryWatchManagerLinux::ReadEvents()
+{
+#if PLATFORM_LINUX
+	alignas(inotify_event) uint8 Buffer[64 * 1024];
+
+	for (;;)
+	{
+		const ssize_t BytesRead = read(InotifyFd, Buffer, sizeof(Buffer));
+		if (BytesRead <= 0)
+		{
+			break;
+		}
+
+		const double Now = FPlatformTime::Seconds();
+		if (PendingChanges.Num() == 0 && PendingMoves.Num() == 0)
+		{
+			FirstPendingTime = Now;
+		}
+		LastEventTime = Now;
+
+		for (ssize_t Offset = 0; Offset < BytesRead;)
+		{
+			const inotify_event* Event = reinterpret_cast<const inotify_event*>(Buffer + Offset);
+			Offset += sizeof(inotify_event) + Event->len;
+
+			if (Event->mask & IN_Q_OVERFLOW)
+			{
+				RecordChange(RootPath, EDirectoryChangeType::Overflow);
+				continue;
+			}
+
+			if (Event->mask & IN_IGNORED)
+			{
+				WatchedDirectories.Remove(Event->wd);
+				continue;
+			}
+
+			const FString* Directory = WatchedDirectories.Find(Event->wd);
+			if (!Directory)
+			{
+				continue;
+			}
+
+			const bool bIsDirectory = (Event->mask & IN_ISDIR) != 0;
+			const FString Path = Event->len > 0 ? *Directory / UTF8_TO_TCHAR(Event->name) : *Directory;
+
+			if (Event->mask & IN_MOVED_FROM)
+			{
+				PendingMoves.Add(Event->cookie, TPair<FString, bool>(Path, bIsDirectory));
+			}
+			else if (Event->mask & IN_MOVED_TO)
+			{
+				TPair<FString, bool> MovedFrom;
+				if (PendingMoves.RemoveAndCopyValue(Event->cookie, MovedFrom))
+				{
+					if (bIsDirectory)
+					{
+						RenameWatches(MovedFrom.Key, Path);
+					}
+					RecordChange(Path, EDirectoryChangeType::Renamed, MovedFrom.Key);
+				}
+				else
+				{
+					// Moved in from outside the watched tree
+					RecordChange(Path, EDirectoryChangeType::Added);
+					if (bIsDirectory && bWatchRecursively)
+					{
+						AddWatch(Path, true);
+					}
+				}
+			}
+			else if (Event->mask & IN_CREATE)
+			{
+				RecordChange(Path, EDirectoryChangeType::Added);
+				if (bIsDirectory && bWatchRecursively)
+				{
+					AddWatch(Path, true);
+				}
+			}
+			else if (Event->mask & IN_DELETE)
+			{
+				RecordChange(Path, EDirectoryChangeType::Removed);
+			}
+			else if (Event->mask & IN_DELETE_SELF)
+			{
+				if (Path.Equals(RootPath, ESearchCase::CaseSensitive))
+				{
+					RecordChange(Path, EDirectoryChangeType::Removed);
+				}
+			}
+			else if (Event->mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB))
+			{
+				// Attribute changes of the watched directory itself come without a name
+				if (!bIsDirectory && Event->len > 0)
+				{
+					RecordChange(Path, EDirectoryChangeType::Modified);
+				}
+			}
+		}
+	}
+#endif
+}
+
+void DirectoryWatchManagerLinux::RecordChange(const FString& Path, EDirectoryChangeType Type, const FString& OldPath)
+{
+	// A rename of something created in this burst is just a creation under the new name
+	if (Type == EDirectoryChangeType::Renamed)
+	{
+		const FDirectoryChange* Previous = PendingChanges.Find(OldPath);
+		if (Previous && Previous->Type == EDirectoryChangeType::Added)
+		{
+			PendingChanges.Remove(OldPath);
+			Type = EDirectoryChangeType::Added;
+		}
+	}
+
+	FDirectoryChange* Existing = PendingChanges.Find(Path);
+	if (!Existing)
+	{
+		PendingChanges.Add(Path, FDirectoryChange{ Path, Type == EDirectoryChangeType::Renamed ? OldPath : FString(), Type });
+		return;
+	}
+
+	// Something was moved over a path that already has a pending change, the old name must not get lost
+	if (Type == EDirectoryChangeType::Renamed)
+	{
+		FString OverwrittenPath;
+		switch (Existing->Type)
+		{
+		case EDirectoryChangeType::Added:
+		case EDirectoryChangeType::Overflow:
+			// Still new (or to be rescanned) for consumers, only the old name is gone
+			OverwrittenPath = OldPath;
+			break;
+
+		case EDirectoryChangeType::Renamed:
+			// The previous rename's source was overwritten, it is gone for good
+			OverwrittenPath = Existing->OldPath;
+			Existing->OldPath = OldPath;
+			break;
+
+		default:
+			Existing->Type = EDirectoryChangeType::Renamed;
+			Existing->OldPath = OldPath;
+			break;
+		}
+
+		if (!OverwrittenPath.IsEmpty())
+		{
+			RecordChange(OverwrittenPath, EDirectoryChangeType::Removed);
+		}
+		return;
+	}
+
+	switch (Existing->Type)
+	{
+	case EDirectoryChangeType::Added:
+		// Added then modified is still added, added then removed never happened
+		if (Type == EDirectoryChangeType::Removed)
+		{
+			PendingChanges.Remove(Path);
+		}
+		break;
+
+	case EDirectoryChangeType::Removed:
+		// Deleted and recreated (the usual atomic save) is a modification
+		if (Type != EDirectoryChangeType::Removed)
+		{
+			Existing->Type = EDirectoryChangeType::Modified;
+		}
+		break;
+
+	case EDirectoryChangeType::Modified:
+		if (Type == EDirectoryChangeType::Removed || Type == EDirectoryChangeType::Overflow)
+		{
+			Existing->Type = Type;
+		}
+		break;
+
+	case EDirectoryChangeType::Renamed:
+		// The old name is gone for good, the new one never showed up
+		if (Type == EDirectoryChangeType::Removed)
+		{
+			const FString RenamedFrom = Existing->OldPath;
+			PendingChanges.Remove(Path);
+			RecordChange(RenamedFrom, EDirectoryChangeType::Removed);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void DirectoryWatchManagerLinux::Flush()
+{
+	// Moves whose other half never arrived crossed the boundary of the watched tree
+	for (const TPair<uint32, TPair<FString, bool>>& Move : PendingMoves)
+	{
+		if (Move.Value.Value)
+		{
+			RemoveWatches(Move.Value.Key);
+		}
+		RecordChange(Move.Value.Key, EDirectoryChangeType::Removed);
+	}
+	PendingMoves.Reset();
+
+	if (PendingChanges.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FDirectoryChange> Changes;
+	PendingChanges.GenerateValueArray(Changes);
+	PendingChanges.Reset();
+
+	if (ChangesCallback)
+	{
+		ChangesCallback(MoveTemp(Changes));
+	}
+}
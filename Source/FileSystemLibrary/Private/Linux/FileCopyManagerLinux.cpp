@@ -0,0 +1,173 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for copying files on the Linux platform without bouncing the data through user-space buffers.
+
+#include "Linux/FileCopyManagerLinux.h"
+
+#if PLATFORM_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+// Older sysroots don't define the reflink ioctl
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
+namespace
+{
+	enum class EKernelCopyResult
+	{
+		Success,
+		// The method isn't available for this pair of files, try the next one
+		Unsupported,
+		Failed,
+		Cancelled
+	};
+
+	bool IsUnsupportedError(int Error)
+	{
+		return Error == ENOSYS || Error == EXDEV || Error == EINVAL || Error == EOPNOTSUPP || Error == ENOTTY || Error == EBADF || Error == EPERM;
+	}
+
+	/** Runs CopyChunk until TotalBytes are copied. CopyChunk returns the number of bytes copied, or -1 with errno set. */
+	template <typename CopyChunkType>
+	EKernelCopyResult CopyInChunks(int64& BytesCopied, int64 TotalBytes, int64 ChunkSize, const FThreadSafeBool* CancelFlag, const FileCopyManager::FProgressCallback& OnProgress, CopyChunkType&& CopyChunk)
+	{
+		while (BytesCopied < TotalBytes)
+		{
+			if (CancelFlag && *CancelFlag)
+			{
+				return EKernelCopyResult::Cancelled;
+			}
+
+			const int64 Copied = CopyChunk(FMath::Min<int64>(ChunkSize, TotalBytes - BytesCopied));
+
+			if (Copied < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				// Only fall back if nothing was written yet, otherwise the destination is half done
+				return (BytesCopied == 0 && IsUnsupportedError(errno)) ? EKernelCopyResult::Unsupported : EKernelCopyResult::Failed;
+			}
+
+			// The source shrank while copying
+			if (Copied == 0)
+			{
+				return EKernelCopyResult::Failed;
+			}
+
+			BytesCopied += Copied;
+
+			if (OnProgress)
+			{
+				OnProgress(BytesCopied, TotalBytes);
+			}
+		}
+
+		return EKernelCopyResult::Success;
+	}
+}
+#endif
+
+EFileCopyResult FileCopyManagerLinux::CopyFile(const FString& PathToFile, const FString& DestinationFilePath, const FThreadSafeBool* CancelFlag, const FProgressCallback& OnProgress, int64 ChunkSize)
+{
+#if PLATFORM_LINUX
+	// Paths the native file system can't open (e.g. mounted pak files) go through IPlatformFile
+	const int SourceFd = open(TCHAR_TO_UTF8(*PathToFile), O_RDONLY | O_CLOEXEC);
+	if (SourceFd < 0)
+	{
+		return FileCopyManager::CopyFile(PathToFile, DestinationFilePath, CancelFlag, OnProgress, ChunkSize);
+	}
+
+	struct stat SourceStat;
+	if (fstat(SourceFd, &SourceStat) != 0 || !S_ISREG(SourceStat.st_mode))
+	{
+		close(SourceFd);
+		return EFileCopyResult::Failed;
+	}
+
+	const int DestinationFd = open(TCHAR_TO_UTF8(*DestinationFilePath), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, SourceStat.st_mode & 0777);
+	if (DestinationFd < 0)
+	{
+		close(SourceFd);
+		return EFileCopyResult::Failed;
+	}
+
+	const int64 TotalBytes = SourceStat.st_size;
+	ChunkSize = FMath::Max<int64>(ChunkSize, CopyAlignment);
+
+	EKernelCopyResult Result = EKernelCopyResult::Unsupported;
+	int64 BytesCopied = 0;
+
+	// Reflink: the destination shares the source extents until one of them is written to
+	if (TotalBytes == 0 || ioctl(DestinationFd, FICLONE, SourceFd) == 0)
+	{
+		BytesCopied = TotalBytes;
+		Result = EKernelCopyResult::Success;
+
+		if (OnProgress && TotalBytes > 0)
+		{
+			OnProgress(BytesCopied, TotalBytes);
+		}
+	}
+
+#if defined(__NR_copy_file_range)
+	// In-kernel copy, server side on NFS/SMB and a block clone on some file systems
+	if (Result == EKernelCopyResult::Unsupported)
+	{
+		loff_t SourceOffset = 0;
+		loff_t DestinationOffset = 0;
+
+		Result = CopyInChunks(BytesCopied, TotalBytes, ChunkSize, CancelFlag, OnProgress, [&](int64 BytesToCopy) -> int64
+		{
+			return syscall(__NR_copy_file_range, SourceFd, &SourceOffset, DestinationFd, &DestinationOffset, size_t(BytesToCopy), 0u);
+		});
+	}
+#endif
+
+	// Page cache to page cache, no user-space buffer. Works across file systems on older kernels that reject copy_file_range
+	if (Result == EKernelCopyResult::Unsupported)
+	{
+		off_t SourceOffset = 0;
+
+		Result = CopyInChunks(BytesCopied, TotalBytes, ChunkSize, CancelFlag, OnProgress, [&](int64 BytesToCopy) -> int64
+		{
+			return sendfile(DestinationFd, SourceFd, &SourceOffset, size_t(BytesToCopy));
+		});
+	}
+
+	close(SourceFd);
+
+	if (close(DestinationFd) != 0 && Result == EKernelCopyResult::Success)
+	{
+		Result = EKernelCopyResult::Failed;
+	}
+
+	switch (Result)
+	{
+	case EKernelCopyResult::Success:
+		return EFileCopyResult::Success;
+
+	case EKernelCopyResult::Unsupported:
+		return FileCopyManager::CopyFile(PathToFile, DestinationFilePath, CancelFlag, OnProgress, ChunkSize);
+
+	case EKernelCopyResult::Cancelled:
+		unlink(TCHAR_TO_UTF8(*DestinationFilePath));
+		return EFileCopyResult::Cancelled;
+
+	default:
+		unlink(TCHAR_TO_UTF8(*DestinationFilePath));
+		return EFileCopyResult::Failed;
+	}
+#else
+	return FileCopyManager::CopyFile(PathToFile, DestinationFilePath, CancelFlag, OnProgress, ChunkSize);
+#endif
+}
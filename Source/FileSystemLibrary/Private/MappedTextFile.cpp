@@ -0,0 +1,396 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "MappedTextFile.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Paths.h"
+#include "Misc/Crc.h"
+#include <string.h>
+
+namespace
+{
+	const uint32 LineIndexMagic = 0x4C4C5346; // "FSLL"
+	const uint32 LineIndexVersion = 1;
+
+	struct FLineIndexHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		// Size and modification time of the text file when it was indexed
+		int64 FileSize;
+		int64 ModificationTicks;
+		int64 NumLines;
+		uint32 PathLength;
+		uint32 Padding;
+	};
+
+	FString GetLineIndexDirectory()
+	{
+		return FPaths::ProjectSavedDir() / TEXT("FileSystemLibrary") / TEXT("LineIndex");
+	}
+
+	/** Reads the header and the full path of the indexed file, leaving IndexFile on the first line position. */
+	bool ReadLineIndexHeader(IFileHandle& IndexFile, FLineIndexHeader& OutHeader, FString& OutIndexedPath)
+	{
+		if (!IndexFile.Read((uint8*)&OutHeader, sizeof(OutHeader)) || OutHeader.Magic != LineIndexMagic || OutHeader.Version != LineIndexVersion)
+		{
+			return false;
+		}
+
+		const int64 ExpectedSize = sizeof(OutHeader) + int64(OutHeader.PathLength) + OutHeader.NumLines * int64(sizeof(int64));
+		if (OutHeader.NumLines < 0 || OutHeader.NumLines > MAX_int32 || IndexFile.Size() != ExpectedSize)
+		{
+			return false;
+		}
+
+		TArray<ANSICHAR> IndexedPath;
+		IndexedPath.SetNumUninitialized(OutHeader.PathLength);
+		if (!IndexFile.Read((uint8*)IndexedPath.GetData(), OutHeader.PathLength))
+		{
+			return false;
+		}
+
+		FUTF8ToTCHAR Converted(IndexedPath.GetData(), IndexedPath.Num());
+		OutIndexedPath = FString(Converted.Length(), Converted.Get());
+		return true;
+	}
+
+	/** Stale once the text file was touched. An edit that keeps both the size and the modification time isn't noticed. */
+	bool IsLineIndexCurrent(const FLineIndexHeader& Header, const FString& PathToFile)
+	{
+		const FFileStatData StatData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*PathToFile);
+		return StatData.bIsValid && Header.FileSize == StatData.FileSize && Header.ModificationTicks == StatData.ModificationTime.GetTicks();
+	}
+}
+
+TSharedPtr<MappedTextFile, ESPMode::ThreadSafe> MappedTextFile::Open(const FString& PathToFile, bool bUseLineIndex)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TSharedPtr<MappedTextFile, ESPMode::ThreadSafe> File = MakeShareable(new MappedTextFile());
+
+	// Mapping an empty file fails on some platforms, it is still a valid text file with no lines
+	if (PlatformFile.FileSize(*PathToFile) == 0)
+	{
+		return File;
+	}
+
+	File->MappedFile.Reset(PlatformFile.OpenMapped(*PathToFile));
+	if (!File->MappedFile)
+	{
+		return nullptr;
+	}
+
+	File->Region.Reset(File->MappedFile->MapRegion(0, File->MappedFile->GetFileSize()));
+	if (!File->Region)
+	{
+		return nullptr;
+	}
+
+	File->Data = File->Region->GetMappedPtr();
+	File->Size = File->Region->GetMappedSize();
+
+	const uint8* Data = File->Data;
+	if (File->Size >= 3 && Data[0] == 0xEF && Data[1] == 0xBB && Data[2] == 0xBF)
+	{
+		File->TextStart = 3;
+	}
+	else if (File->Size >= 2 && Data[0] == 0xFF && Data[1] == 0xFE)
+	{
+		File->Encoding = EEncoding::Utf16LittleEndian;
+		File->TextStart = 2;
+	}
+	else if (File->Size >= 2 && Data[0] == 0xFE && Data[1] == 0xFF)
+	{
+		File->Encoding = EEncoding::Utf16BigEndian;
+		File->TextStart = 2;
+	}
+
+	if (bUseLineIndex && File->LoadLineIndex(PathToFile))
+	{
+		return File;
+	}
+
+	File->IndexLines();
+
+	if (bUseLineIndex)
+	{
+		SaveLineIndex(PathToFile, File->LineStarts);
+	}
+	return File;
+}
+
+FString MappedTextFile::GetLineIndexPath(const FString& PathToFile)
+{
+	const FString FullPath = FPaths::ConvertRelativePathToFull(PathToFile);
+	const FString IndexName = FString::Printf(TEXT("%s-%08X.lines"), *FPaths::GetCleanFilename(FullPath), FCrc::StrCrc32(*FullPath));
+	return GetLineIndexDirectory() / IndexName;
+}
+
+bool MappedTextFile::SaveLineIndex(const FString& PathToFile, const TArray<int64>& LineStarts)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	const FFileStatData StatData = PlatformFile.GetStatData(*PathToFile);
+	if (!StatData.bIsValid)
+	{
+		return false;
+	}
+
+	FTCHARToUTF8 ConvertedPath(*FPaths::ConvertRelativePathToFull(PathToFile));
+
+	FLineIndexHeader Header = {};
+	Header.Magic = LineIndexMagic;
+	Header.Version = LineIndexVersion;
+	Header.FileSize = StatData.FileSize;
+	Header.ModificationTicks = StatData.ModificationTime.GetTicks();
+	Header.NumLines = LineStarts.Num();
+	Header.PathLength = ConvertedPath.Length();
+
+	// Write next to the target and swap, a crash mid-write never leaves a truncated index behind
+	const FString IndexPath = GetLineIndexPath(PathToFile);
+	const FString TempPath = IndexPath + TEXT(".tmp");
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(IndexPath));
+
+	{
+		TUniquePtr<IFileHandle> IndexFile(PlatformFile.OpenWrite(*TempPath));
+		if (!IndexFile)
+		{
+			return false;
+		}
+
+		const bool bWritten = IndexFile->Write((const uint8*)&Header, sizeof(Header))
+			&& IndexFile->Write((const uint8*)ConvertedPath.Get(), ConvertedPath.Length())
+			&& IndexFile->Write((const uint8*)LineStarts.GetData(), LineStarts.Num() * sizeof(int64));
+
+		if (!bWritten)
+		{
+			IndexFile.Reset();
+			PlatformFile.DeleteFile(*TempPath);
+			return false;
+		}
+	}
+
+	PlatformFile.DeleteFile(*IndexPath);
+	return PlatformFile.MoveFile(*IndexPath, *TempPath);
+}
+
+bool MappedTextFile::LoadLineIndex(const FString& PathToFile)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IFileHandle> IndexFile(PlatformFile.OpenRead(*GetLineIndexPath(PathToFile)));
+	if (!IndexFile)
+	{
+		return false;
+	}
+
+	// Different files can share an index name, the full path tells them apart
+	FLineIndexHeader Header;
+	FString IndexedPath;
+	if (!ReadLineIndexHeader(*IndexFile, Header, IndexedPath) || !IndexedPath.Equals(FPaths::ConvertRelativePathToFull(PathToFile), ESearchCase::CaseSensitive)
+		|| Header.FileSize != Size || !IsLineIndexCurrent(Header, PathToFile))
+	{
+		return false;
+	}
+
+	LineStarts.SetNumUninitialized(int32(Header.NumLines));
+	if (!IndexFile->Read((uint8*)LineStarts.GetData(), Header.NumLines * sizeof(int64)))
+	{
+		LineStarts.Reset();
+		return false;
+	}
+
+	// Every line view is cut from two neighbouring positions, one bad entry would read past the mapping
+	bool bValid = LineStarts.Num() == 0 || LineStarts[0] == TextStart;
+	for (int32 Index = 0; bValid && Index < LineStarts.Num(); Index++)
+	{
+		bValid = LineStarts[Index] < Size && (Index == 0 || LineStarts[Index] > LineStarts[Index - 1]);
+	}
+
+	if (!bValid)
+	{
+		LineStarts.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedTextFile::PurgeStaleLineIndexes()
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TArray<FString> StaleFiles;
+	PlatformFile.IterateDirectory(*GetLineIndexDirectory(), [&PlatformFile, &StaleFiles](const TCHAR* FilenameOrDirectory, bool bIsDirectory)
+	{
+		if (bIsDirectory)
+		{
+			return true;
+		}
+
+		// Leftovers of an interrupted save, and indexes of files that changed or are gone
+		bool bStale = !FString(FilenameOrDirectory).EndsWith(TEXT(".lines"));
+		if (!bStale)
+		{
+			TUniquePtr<IFileHandle> IndexFile(PlatformFile.OpenRead(FilenameOrDirectory));
+			FLineIndexHeader Header;
+			FString IndexedPath;
+			bStale = !IndexFile || !ReadLineIndexHeader(*IndexFile, Header, IndexedPath) || !IsLineIndexCurrent(Header, IndexedPath);
+		}
+
+		if (bStale)
+		{
+			StaleFiles.Add(FilenameOrDirectory);
+		}
+		return true;
+	});
+
+	for (const FString& StaleFile : StaleFiles)
+	{
+		PlatformFile.DeleteFile(*StaleFile);
+	}
+}
+
+MappedTextFile::~MappedTextFile()
+{
+	// The region has to go before the file it maps
+	Region.Reset();
+	MappedFile.Reset();
+}
+
+void MappedTextFile::IndexLines()
+{
+	if (TextStart >= Size)
+	{
+		return;
+	}
+
+	LineStarts.Add(TextStart);
+
+	if (Encoding == EEncoding::Utf8)
+	{
+		// memchr is vectorized by every C library we ship on, this is the whole cost of opening a file
+		for (const uint8* Cursor = Data + TextStart; const uint8* NewLine = (const uint8*)memchr(Cursor, '\n', Data + Size - Cursor);)
+		{
+			Cursor = NewLine + 1;
+			if (Cursor < Data + Size)
+			{
+				LineStarts.Add(Cursor - Data);
+			}
+			else
+			{
+				break;
+			}
+		}
+		return;
+	}
+
+	const int32 NewLineByte = Encoding == EEncoding::Utf16LittleEndian ? 0 : 1;
+	for (int64 Offset = TextStart; Offset + 1 < Size; Offset += 2)
+	{
+		if (Data[Offset + NewLineByte] == '\n' && Data[Offset + 1 - NewLineByte] == 0 && Offset + 2 < Size)
+		{
+			LineStarts.Add(Offset + 2);
+		}
+	}
+}
+
+MappedTextFile::FLineView MappedTextFile::GetLineView(int32 Index) const
+{
+	const int32 UnitSize = Encoding == EEncoding::Utf8 ? 1 : 2;
+
+	FLineView View;
+	View.Offset = LineStarts[Index];
+	View.Length = (Index + 1 < LineStarts.Num() ? LineStarts[Index + 1] : Size) - View.Offset;
+
+	// Drop the line break, LF or CRLF
+	auto IsUnit = [this, UnitSize](int64 Offset, uint8 Char)
+	{
+		if (UnitSize == 1)
+		{
+			return Data[Offset] == Char;
+		}
+		const int32 LowByte = Encoding == EEncoding::Utf16LittleEndian ? 0 : 1;
+		return Data[Offset + LowByte] == Char && Data[Offset + 1 - LowByte] == 0;
+	};
+
+	if (View.Length >= UnitSize && IsUnit(View.Offset + View.Length - UnitSize, '\n'))
+	{
+		View.Length -= UnitSize;
+	}
+	if (View.Length >= UnitSize && IsUnit(View.Offset + View.Length - UnitSize, '\r'))
+	{
+		View.Length -= UnitSize;
+	}
+	return View;
+}
+
+FString MappedTextFile::Decode(const FLineView& View) const
+{
+	if (View.Length <= 0)
+	{
+		return FString();
+	}
+
+	if (Encoding == EEncoding::Utf8)
+	{
+		FUTF8ToTCHAR Converted((const ANSICHAR*)(Data + View.Offset), (int32)View.Length);
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	// TCHAR is UTF-16 on every platform we build for, only the byte order may need fixing
+	static_assert(sizeof(TCHAR) == 2, "UTF-16 decoding expects 2-byte TCHARs");
+
+	const int32 NumUnits = int32(View.Length / 2);
+	FString Line;
+	Line.GetCharArray().SetNumUninitialized(NumUnits + 1);
+	TCHAR* Chars = Line.GetCharArray().GetData();
+	FMemory::Memcpy(Chars, Data + View.Offset, NumUnits * 2);
+	Chars[NumUnits] = 0;
+
+#if PLATFORM_LITTLE_ENDIAN
+	const bool bSwap = Encoding == EEncoding::Utf16BigEndian;
+#else
+	const bool bSwap = Encoding == EEncoding::Utf16LittleEndian;
+#endif
+	if (bSwap)
+	{
+		for (int32 Index = 0; Index < NumUnits; Index++)
+		{
+			Chars[Index] = TCHAR(uint16(Chars[Index] >> 8) | uint16(Chars[Index] << 8));
+		}
+	}
+	return Line;
+}
+
+FString MappedTextFile::GetLine(int32 Index) const
+{
+	return Decode(GetLineView(Index));
+}
+
+void MappedTextFile::GetLines(int32 First, int32 Count, TArray<FString>& OutLines) const
+{
+	First = FMath::Max(First, 0);
+	const int32 Last = FMath::Min<int64>(int64(First) + FMath::Max(Count, 0), LineStarts.Num());
+
+	OutLines.Reserve(OutLines.Num() + FMath::Max(Last - First, 0));
+	for (int32 Index = First; Index < Last; Index++)
+	{
+		OutLines.Add(GetLine(Index));
+	}
+}
+
+FString MappedTextFile::GetText() const
+{
+	FString Text;
+	Text.Reserve(int32(FMath::Min<int64>(Size, MAX_int32)));
+
+	for (int32 Index = 0; Index < LineStarts.Num(); Index++)
+	{
+		Text += GetLine(Index);
+		Text.AppendChar(TEXT('\n'));
+	}
+	return Text;
+}
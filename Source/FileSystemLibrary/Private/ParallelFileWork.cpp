@@ -0,0 +1,232 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "ParallelFileWork.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Event.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
+
+namespace
+{
+	FCriticalSection ThreadPoolLock;
+	// Below normal for foreground work, lowest for background work
+	FQueuedThreadPool* FileWorkThreadPools[2] = { nullptr, nullptr };
+
+	FQueuedThreadPool* GetFileWorkThreadPool(bool bBackgroundPriority)
+	{
+		FScopeLock Lock(&ThreadPoolLock);
+
+		FQueuedThreadPool*& ThreadPool = FileWorkThreadPools[bBackgroundPriority ? 1 : 0];
+		if (!ThreadPool)
+		{
+			ThreadPool = FQueuedThreadPool::Allocate();
+			if (!ThreadPool->Create(ParallelFileWork::GetDefaultConcurrency(), 128 * 1024, bBackgroundPriority ? TPri_Lowest : TPri_BelowNormal,
+				bBackgroundPriority ? TEXT("FileSystemLibraryBackgroundFileWork") : TEXT("FileSystemLibraryFileWork")))
+			{
+				delete ThreadPool;
+				ThreadPool = nullptr;
+			}
+		}
+		return ThreadPool;
+	}
+
+	/** One worker of a ParallelFileWork call running on a file work thread pool. */
+	class FFileWorkItem : public IQueuedWork
+	{
+	public:
+		explicit FFileWorkItem(TFunction<void()>&& InWork)
+			: Work(MoveTemp(InWork))
+			, Done(FPlatformProcess::GetSynchEventFromPool(true))
+		{
+		}
+
+		~FFileWorkItem()
+		{
+			FPlatformProcess::ReturnSynchEventToPool(Done);
+		}
+
+		virtual void DoThreadedWork() override
+		{
+			Work();
+			Done->Trigger();
+		}
+
+		virtual void Abandon() override
+		{
+			Done->Trigger();
+		}
+
+		TFunction<void()> Work;
+		FEvent* Done;
+	};
+
+	/** Runs WorkerBody once per worker index in [0, NumWorkers) and returns once all of them are done. The calling thread is worker 0,
+	 * so the work gets done even when every pool thread is busy (e.g. a nested call); WorkerBody has to cope with workers that never start.
+	 */
+	void RunWorkers(int32 NumWorkers, bool bBackgroundPriority, TFunctionRef<void(int32 WorkerIndex)> WorkerBody)
+	{
+		FQueuedThreadPool* ThreadPool = NumWorkers > 1 ? GetFileWorkThreadPool(bBackgroundPriority) : nullptr;
+
+		TArray<TUniquePtr<FFileWorkItem>> Helpers;
+		if (ThreadPool)
+		{
+			for (int32 WorkerIndex = 1; WorkerIndex < NumWorkers; WorkerIndex++)
+			{
+				Helpers.Add(MakeUnique<FFileWorkItem>([&WorkerBody, WorkerIndex]() { WorkerBody(WorkerIndex); }));
+				ThreadPool->AddQueuedWork(Helpers.Last().Get());
+			}
+		}
+
+		WorkerBody(0);
+
+		for (const TUniquePtr<FFileWorkItem>& Helper : Helpers)
+		{
+			// Helpers that never started have nothing left to do, the others have to let go of the shared state first
+			if (!ThreadPool->RetractQueuedWork(Helper.Get()))
+			{
+				Helper->Done->Wait();
+			}
+		}
+	}
+}
+
+int32 ParallelFileWork::GetDefaultConcurrency()
+{
+	// File work is mostly waiting on the device, so use every hardware thread rather than only the physical cores
+	return FMath::Max(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1);
+}
+
+void ParallelFileWork::ForEach(int32 Num, int32 MaxConcurrency, TFunctionRef<void(int32 Index)> Body, bool bBackgroundPriority)
+{
+	if (Num <= 0)
+	{
+		return;
+	}
+
+	const int32 NumWorkers = FMath::Clamp(MaxConcurrency > 0 ? MaxConcurrency : GetDefaultConcurrency(), 1, Num);
+
+	// Workers pull the next index themselves so one slow file doesn't hold back a pre-assigned range
+	std::atomic<int32> NextIndex(0);
+
+	RunWorkers(NumWorkers, bBackgroundPriority, [&NextIndex, Num, &Body](int32 WorkerIndex)
+	{
+		for (int32 Index = NextIndex++; Index < Num; Index = NextIndex++)
+		{
+			Body(Index);
+		}
+	});
+}
+
+void ParallelFileWork::Shutdown()
+{
+	FScopeLock Lock(&ThreadPoolLock);
+
+	for (FQueuedThreadPool*& ThreadPool : FileWorkThreadPools)
+	{
+		if (ThreadPool)
+		{
+			ThreadPool->Destroy();
+			delete ThreadPool;
+			ThreadPool = nullptr;
+		}
+	}
+}
+
+FileTaskScheduler::FileTaskScheduler(int32 MaxConcurrency)
+	: PendingTasks(0)
+	, WorkAvailable(FPlatformProcess::GetSynchEventFromPool(true))
+	, WorkGeneration(0)
+{
+	const int32 NumWorkers = MaxConcurrency > 0 ? MaxConcurrency : ParallelFileWork::GetDefaultConcurrency();
+
+	for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; WorkerIndex++)
+	{
+		Queues.Add(MakeUnique<FWorkerQueue>());
+	}
+}
+
+FileTaskScheduler::~FileTaskScheduler()
+{
+	FPlatformProcess::ReturnSynchEventToPool(WorkAvailable);
+}
+
+void FileTaskScheduler::Spawn(int32 WorkerIndex, FTask&& Task)
+{
+	PendingTasks++;
+
+	{
+		FWorkerQueue& Queue = *Queues[WorkerIndex];
+		FScopeLock Lock(&Queue.Lock);
+		Queue.Tasks.Add(MoveTemp(Task));
+	}
+
+	WorkGeneration++;
+	WorkAvailable->Trigger();
+}
+
+bool FileTaskScheduler::PopOrSteal(int32 WorkerIndex, FTask& OutTask)
+{
+	// Own deque first, newest task
+	{
+		FWorkerQueue& Queue = *Queues[WorkerIndex];
+		FScopeLock Lock(&Queue.Lock);
+		if (Queue.Tasks.Num() > 0)
+		{
+			OutTask = Queue.Tasks.Pop(EAllowShrinking::No);
+			return true;
+		}
+	}
+
+	// Then the oldest task of any other worker
+	for (int32 Offset = 1; Offset < Queues.Num(); Offset++)
+	{
+		FWorkerQueue& Victim = *Queues[(WorkerIndex + Offset) % Queues.Num()];
+		FScopeLock Lock(&Victim.Lock);
+		if (Victim.Tasks.Num() > 0)
+		{
+			OutTask = MoveTemp(Victim.Tasks[0]);
+			Victim.Tasks.RemoveAt(0, 1, EAllowShrinking::No);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FileTaskScheduler::Run()
+{
+	RunWorkers(Queues.Num(), false, [this](int32 WorkerIndex)
+	{
+		WorkerLoop(WorkerIndex);
+	});
+}
+
+void FileTaskScheduler::WorkerLoop(int32 WorkerIndex)
+{
+	while (PendingTasks > 0)
+	{
+		const uint32 Generation = WorkGeneration;
+
+		FTask Task;
+		if (PopOrSteal(WorkerIndex, Task))
+		{
+			Task(*this, WorkerIndex);
+			if (--PendingTasks == 0)
+			{
+				// Wake the idle workers so they can leave
+				WorkAvailable->Trigger();
+			}
+			continue;
+		}
+
+		// Another worker is busy and may still spawn work, sleep until it does or everything is done
+		WorkAvailable->Reset();
+		if (Generation == WorkGeneration && PendingTasks > 0)
+		{
+			// The timeout only covers a wake-up racing with the reset above
+			WorkAvailable->Wait(10);
+		}
+	}
+}
@@ -0,0 +1,335 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+#include "PersistentFileIndex.h"
+#include "DirectoryWalkManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Paths.h"
+#include "Templates/UniquePtr.h"
+
+namespace
+{
+	const uint32 IndexMagic = 0x494C5346; // "FSLI"
+	const uint32 IndexVersion = 1;
+
+	struct FIndexHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 RootPathLength;
+		uint32 NumDirectories;
+		uint32 NumFiles;
+		uint32 NumStringBytes;
+	};
+}
+
+uint32 PersistentFileIndex::AddString(const FString& String, uint32& OutLength)
+{
+	FTCHARToUTF8 Converted(*String);
+
+	const uint32 Offset = Strings.Num();
+	OutLength = Converted.Length();
+	Strings.Append(Converted.Get(), Converted.Length());
+	return Offset;
+}
+
+FString PersistentFileIndex::GetString(uint32 Offset, uint32 Length) const
+{
+	FUTF8ToTCHAR Converted(Strings.GetData() + Offset, Length);
+	return FString(Converted.Length(), Converted.Get());
+}
+
+void PersistentFileIndex::ListDirectory(const FString& RelativePath, int64 ModificationTicks, TArray<TPair<FString, int64>>& OutSubDirectories)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	FIndexedDirectory& Directory = Directories.AddDefaulted_GetRef();
+	Directory.PathOffset = AddString(RelativePath, Directory.PathLength);
+	Directory.ModificationTicks = ModificationTicks;
+	Directory.FirstFile = Files.Num();
+	Directory.NumFiles = 0;
+
+	const int32 DirectoryIndex = Directories.Num() - 1;
+
+	PlatformFile.IterateDirectoryStat(*(RootPath / RelativePath), [this, DirectoryIndex, &RelativePath, &OutSubDirectories](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+	{
+		const FString Name = FPaths::GetCleanFilename(FilenameOrDirectory);
+
+		if (StatData.bIsDirectory)
+		{
+			OutSubDirectories.Emplace(RelativePath.IsEmpty() ? Name : RelativePath / Name, StatData.ModificationTime.GetTicks());
+		}
+		else
+		{
+			FIndexedFile& File = Files.AddDefaulted_GetRef();
+			File.NameOffset = AddString(Name, File.NameLength);
+			File.Size = StatData.FileSize;
+			File.ModificationTicks = StatData.ModificationTime.GetTicks();
+			Directories[DirectoryIndex].NumFiles++;
+		}
+		return true;
+	});
+}
+
+bool PersistentFileIndex::Build(const FString& InRootPath)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	RootPath = InRootPath;
+	FPaths::NormalizeDirectoryName(RootPath);
+	Directories.Reset();
+	Files.Reset();
+	Strings.Reset();
+
+	const FFileStatData RootStat = PlatformFile.GetStatData(*RootPath);
+	if (!RootStat.bIsValid || !RootStat.bIsDirectory)
+	{
+		return false;
+	}
+
+	TArray<TPair<FString, int64>> PendingDirectories;
+	PendingDirectories.Emplace(FString(), RootStat.ModificationTime.GetTicks());
+
+	while (PendingDirectories.Num() > 0)
+	{
+		const TPair<FString, int64> Directory = PendingDirectories.Pop(EAllowShrinking::No);
+		ListDirectory(Directory.Key, Directory.Value, PendingDirectories);
+	}
+
+	return true;
+}
+
+bool PersistentFileIndex::Refresh()
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	// Keep the old index around to copy unchanged directories from
+	const TArray<FIndexedDirectory> OldDirectories = MoveTemp(Directories);
+	const TArray<FIndexedFile> OldFiles = MoveTemp(Files);
+	const TArray<ANSICHAR> OldStrings = MoveTemp(Strings);
+	Directories.Reset();
+	Files.Reset();
+	Strings.Reset();
+
+	auto GetOldString = [&OldStrings](uint32 Offset, uint32 Length)
+	{
+		FUTF8ToTCHAR Converted(OldStrings.GetData() + Offset, Length);
+		return FString(Converted.Length(), Converted.Get());
+	};
+
+	// Old directories by path, and their children, so an unchanged directory never needs to be listed
+	TMap<FString, int32> OldDirectoryIndices;
+	TMap<FString, TArray<int32>> OldChildren;
+	for (int32 Index = 0; Index < OldDirectories.Num(); Index++)
+	{
+		const FString Path = GetOldString(OldDirectories[Index].PathOffset, OldDirectories[Index].PathLength);
+		OldDirectoryIndices.Add(Path, Index);
+		if (!Path.IsEmpty())
+		{
+			OldChildren.FindOrAdd(FPaths::GetPath(Path)).Add(Index);
+		}
+	}
+
+	const FFileStatData RootStat = PlatformFile.GetStatData(*RootPath);
+	if (!RootStat.bIsValid || !RootStat.bIsDirectory)
+	{
+		return OldDirectories.Num() > 0;
+	}
+
+	bool bChanged = false;
+
+	TArray<TPair<FString, int64>> PendingDirectories;
+	PendingDirectories.Emplace(FString(), RootStat.ModificationTime.GetTicks());
+
+	while (PendingDirectories.Num() > 0)
+	{
+		const TPair<FString, int64> Directory = PendingDirectories.Pop(EAllowShrinking::No);
+		const int32* OldIndex = OldDirectoryIndices.Find(Directory.Key);
+
+		if (!OldIndex || OldDirectories[*OldIndex].ModificationTicks != Directory.Value)
+		{
+			bChanged = true;
+			ListDirectory(Directory.Key, Directory.Value, PendingDirectories);
+			continue;
+		}
+
+		// Unchanged, copy its files over and only stat its sub-directories
+		const FIndexedDirectory& OldDirectory = OldDirectories[*OldIndex];
+
+		FIndexedDirectory& NewDirectory = Directories.AddDefaulted_GetRef();
+		NewDirectory.PathOffset = AddString(Directory.Key, NewDirectory.PathLength);
+		NewDirectory.ModificationTicks = OldDirectory.ModificationTicks;
+		NewDirectory.FirstFile = Files.Num();
+		NewDirectory.NumFiles = OldDirectory.NumFiles;
+
+		for (uint32 FileIndex = OldDirectory.FirstFile; FileIndex < OldDirectory.FirstFile + OldDirectory.NumFiles; FileIndex++)
+		{
+			FIndexedFile File = OldFiles[FileIndex];
+			File.NameOffset = Strings.Num();
+			Strings.Append(OldStrings.GetData() + OldFiles[FileIndex].NameOffset, File.NameLength);
+			Files.Add(File);
+		}
+
+		if (const TArray<int32>* Children = OldChildren.Find(Directory.Key))
+		{
+			for (int32 ChildIndex : *Children)
+			{
+				const FString ChildPath = GetOldString(OldDirectories[ChildIndex].PathOffset, OldDirectories[ChildIndex].PathLength);
+				const FFileStatData ChildStat = PlatformFile.GetStatData(*(RootPath / ChildPath));
+
+				// Can't be gone, or the parent's time would have changed, but the tree may have moved under us
+				if (ChildStat.bIsValid && ChildStat.bIsDirectory)
+				{
+					PendingDirectories.Emplace(ChildPath, ChildStat.ModificationTime.GetTicks());
+				}
+			}
+		}
+	}
+
+	return bChanged || Directories.Num() != OldDirectories.Num();
+}
+
+bool PersistentFileIndex::Save(const FString& IndexFilePath) const
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	FTCHARToUTF8 ConvertedRoot(*RootPath);
+
+	FIndexHeader Header;
+	Header.Magic = IndexMagic;
+	Header.Version = IndexVersion;
+	Header.RootPathLength = ConvertedRoot.Length();
+	Header.NumDirectories = Directories.Num();
+	Header.NumFiles = Files.Num();
+	Header.NumStringBytes = Strings.Num();
+
+	// Write next to the target and swap, a crash mid-write never leaves a truncated index behind
+	const FString TempPath = IndexFilePath + TEXT(".tmp");
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(IndexFilePath));
+
+	{
+		TUniquePtr<IFileHandle> File(PlatformFile.OpenWrite(*TempPath));
+		if (!File)
+		{
+			return false;
+		}
+
+		const bool bWritten = File->Write((const uint8*)&Header, sizeof(Header))
+			&& File->Write((const uint8*)ConvertedRoot.Get(), ConvertedRoot.Length())
+			&& File->Write((const uint8*)Directories.GetData(), Directories.Num() * sizeof(FIndexedDirectory))
+			&& File->Write((const uint8*)Files.GetData(), Files.Num() * sizeof(FIndexedFile))
+			&& File->Write((const uint8*)Strings.GetData(), Strings.Num());
+
+		if (!bWritten)
+		{
+			File.Reset();
+			PlatformFile.DeleteFile(*TempPath);
+			return false;
+		}
+	}
+
+	PlatformFile.DeleteFile(*IndexFilePath);
+	return PlatformFile.MoveFile(*IndexFilePath, *TempPath);
+}
+
+bool PersistentFileIndex::Load(const FString& IndexFilePath)
+{
+	IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*IndexFilePath));
+	if (!MappedFile || MappedFile->GetFileSize() < (int64)sizeof(FIndexHeader))
+	{
+		return false;
+	}
+
+	TUniquePtr<IMappedFileRegion> Region(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	if (!Region)
+	{
+		return false;
+	}
+
+	const uint8* Data = Region->GetMappedPtr();
+	const int64 DataSize = Region->GetMappedSize();
+
+	FIndexHeader Header;
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+
+	const int64 ExpectedSize = sizeof(FIndexHeader) + int64(Header.RootPathLength) + int64(Header.NumDirectories) * sizeof(FIndexedDirectory) + int64(Header.NumFiles) * sizeof(FIndexedFile) + Header.NumStringBytes;
+	if (Header.Magic != IndexMagic || Header.Version != IndexVersion || ExpectedSize != DataSize)
+	{
+		return false;
+	}
+
+	// The tables are plain data, a straight copy out of the mapping is all the parsing there is
+	const uint8* Cursor = Data + sizeof(FIndexHeader);
+
+	FUTF8ToTCHAR ConvertedRoot((const ANSICHAR*)Cursor, Header.RootPathLength);
+	RootPath = FString(ConvertedRoot.Length(), ConvertedRoot.Get());
+	Cursor += Header.RootPathLength;
+
+	Directories.SetNumUninitialized(Header.NumDirectories);
+	FMemory::Memcpy(Directories.GetData(), Cursor, Header.NumDirectories * sizeof(FIndexedDirectory));
+	Cursor += Header.NumDirectories * sizeof(FIndexedDirectory);
+
+	Files.SetNumUninitialized(Header.NumFiles);
+	FMemory::Memcpy(Files.GetData(), Cursor, Header.NumFiles * sizeof(FIndexedFile));
+	Cursor += Header.NumFiles * sizeof(FIndexedFile);
+
+	Strings.SetNumUninitialized(Header.NumStringBytes);
+	FMemory::Memcpy(Strings.GetData(), Cursor, Header.NumStringBytes);
+
+	// The tables are trusted from here on, a corrupt entry must not send GetFiles or Refresh out of bounds
+	auto IsValidString = [this](uint32 Offset, uint32 Length)
+	{
+		return uint64(Offset) + Length <= uint64(Strings.Num());
+	};
+
+	bool bValid = true;
+	for (const FIndexedDirectory& Directory : Directories)
+	{
+		bValid &= IsValidString(Directory.PathOffset, Directory.PathLength) && uint64(Directory.FirstFile) + Directory.NumFiles <= uint64(Files.Num());
+	}
+	for (const FIndexedFile& File : Files)
+	{
+		bValid &= IsValidString(File.NameOffset, File.NameLength);
+	}
+
+	if (!bValid)
+	{
+		RootPath.Reset();
+		Directories.Reset();
+		Files.Reset();
+		Strings.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+void PersistentFileIndex::GetFiles(TArray<FString>& OutFiles, const FString& ExtensionFilter) const
+{
+	// Compare against the UTF-8 name bytes, so filtered out files are never converted
+	FTCHARToUTF8 ConvertedExtension(*DirectoryWalkManager::NormalizeExtensionFilter(ExtensionFilter));
+	const int32 ExtensionLength = ConvertedExtension.Length();
+
+	for (const FIndexedDirectory& Directory : Directories)
+	{
+		const FString DirectoryPath = RootPath / GetString(Directory.PathOffset, Directory.PathLength);
+
+		for (uint32 FileIndex = Directory.FirstFile; FileIndex < Directory.FirstFile + Directory.NumFiles; FileIndex++)
+		{
+			const FIndexedFile& File = Files[FileIndex];
+
+			if (ExtensionLength > 0)
+			{
+				if ((int32)File.NameLength < ExtensionLength || FCStringAnsi::Strnicmp(Strings.GetData() + File.NameOffset + File.NameLength - ExtensionLength, ConvertedExtension.Get(), ExtensionLength) != 0)
+				{
+					continue;
+				}
+			}
+
+			OutFiles.Add(DirectoryPath / GetString(File.NameOffset, File.NameLength));
+		}
+	}
+}
@@ -0,0 +1,95 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for storing large lists of file paths compactly. Every directory is stored once, as a node holding its own
+// name and its parent (a prefix trie); file names are packed as UTF-8 in one arena. Full paths are only rebuilt when asked for.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FILESYSTEMLIBRARY_API CompactPathList
+{
+
+public:
+	explicit CompactPathList(const FString& RootPath = FString());
+
+	/** Adds the file Name of Directory, which has to be RootPath or below it. Files of the same directory are cheapest added one after the other. */
+	void AddFile(const FString& Directory, const TCHAR* Name);
+
+	/** Moves every file of Other (which has to share the same root) to the end of this list. */
+	void Append(CompactPathList&& Other);
+
+	/** Orders the files by directory path, then by name (both compared case-sensitively), so the order doesn't depend on how they were added. */
+	void Sort();
+
+	/** Drops the lookup tables only needed while adding and trims the arrays, call once the list is complete. Adding afterwards rebuilds them. */
+	void Shrink();
+
+	int32 Num() const { return Files.Num(); }
+
+	/** Rebuilds the full path of file Index. */
+	FString GetPath(int32 Index) const;
+
+	/** File name of file Index, without its directory. */
+	FString GetFileName(int32 Index) const;
+
+	void ToArray(TArray<FString>& OutPaths) const;
+
+	/** Approximate memory used, for comparison with the equivalent TArray<FString>. */
+	SIZE_T GetAllocatedSize() const;
+
+	const FString& GetRootPath() const { return RootPath; }
+
+private:
+	struct FDirectoryNode
+	{
+		int32 Parent;
+		uint32 NameOffset;
+		uint32 NameLength;
+	};
+
+	struct FFileEntry
+	{
+		int32 Directory;
+		uint32 NameOffset;
+		uint32 NameLength;
+	};
+
+	/** Returns the node of the directory at RelativePath ("" for the root), creating it and its parents if needed. */
+	int32 FindOrAddDirectory(const FString& RelativePath);
+
+	FString GetDirectoryPath(int32 DirectoryIndex) const;
+
+	uint32 AddName(const TCHAR* Name, uint32& OutLength);
+
+	FString RootPath;
+
+	TArray<FDirectoryNode> Directories;
+	TArray<FFileEntry> Files;
+	// UTF-8 directory segments and file names, back to back
+	TArray<ANSICHAR> Names;
+
+#if PLATFORM_LINUX
+	// Linux file systems are case sensitive, FString keys are not by default
+	struct FCaseSensitivePathKeyFuncs : TDefaultMapKeyFuncs<FString, int32, false>
+	{
+		static bool Matches(const FString& A, const FString& B)
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+
+		static uint32 GetKeyHash(const FString& Key)
+		{
+			return FCrc::StrCrc32(*Key);
+		}
+	};
+	typedef TMap<FString, int32, FDefaultSetAllocator, FCaseSensitivePathKeyFuncs> FDirectoryLookup;
+#else
+	typedef TMap<FString, int32> FDirectoryLookup;
+#endif
+
+	// Only used while adding
+	FDirectoryLookup DirectoryLookup;
+	FString LastDirectory;
+	int32 LastDirectoryIndex = INDEX_NONE;
+};
@@ -0,0 +1,47 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for searching the content of many files at once ("grep"). Files are memory mapped and scanned on a
+// pool of workers; literal patterns use memchr and Boyer-Moore-Horspool on the raw bytes, regular expressions use FRegexMatcher.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+
+class FileFilter;
+
+struct FContentSearchMatch
+{
+	FString Path;
+	// 1-based, Column counts bytes for literal patterns and characters for regular expressions
+	int32 Line = 0;
+	int32 Column = 0;
+	FString LineText;
+};
+
+struct FContentSearchOptions
+{
+	bool bRegex = false;
+	bool bCaseSensitive = true;
+	/** Stop looking in a file after this many matches, 0 for no limit. */
+	int32 MaxMatchesPerFile = 0;
+	/** Longer lines are cut in the reported LineText. */
+	int32 MaxLineTextLength = 512;
+};
+
+class FILESYSTEMLIBRARY_API ContentSearchManager
+{
+
+public:
+	/** Receives the matches of one file as soon as it has been searched. Called from the worker threads. */
+	typedef TFunction<void(TArray<FContentSearchMatch>&& Matches)> FMatchesCallback;
+
+	/** Searches every file below PathToDirectory passing Filter for Pattern, on at most MaxConcurrency workers (0 uses every hardware thread).
+	 * Files with a NUL byte in their first 8 KB are considered binary and skipped. Stops early when CancelFlag is raised.
+	 * Returns false if the directory can't be read, or if Pattern is empty or not a valid regular expression (with bRegex).
+	 */
+	static bool Search(const FString& PathToDirectory, const FileFilter& Filter, const FString& Pattern, const FContentSearchOptions& Options, int32 MaxConcurrency, const FThreadSafeBool* CancelFlag, const FMatchesCallback& OnMatches);
+
+	/** Searches a single file, returns false if it can't be mapped, is binary, or Pattern is not a valid regular expression (with bRegex). */
+	static bool SearchFile(const FString& PathToFile, const FString& Pattern, const FContentSearchOptions& Options, TArray<FContentSearchMatch>& OutMatches);
+};
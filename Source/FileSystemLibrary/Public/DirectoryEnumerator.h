@@ -0,0 +1,61 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for walking a directory tree and handing out the files it finds in fixed-size batches,
+// so a caller can start working before the walk is over and never holds the whole listing at once.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FILESYSTEMLIBRARY_API DirectoryEnumerator
+{
+
+public:
+	/** ExtensionFilter is ".XXX" or "XXX", empty for every file. With bOnlyFilenames, files are returned without their directory and extension. */
+	DirectoryEnumerator(const FString& PathToDirectory, const FString& ExtensionFilter, bool bRecursive, int32 BatchSize, bool bOnlyFilenames = false);
+
+	/** Replaces the content of OutBatch with the next (at most BatchSize) files. Returns false once the walk is over and nothing was left. */
+	bool NextBatch(TArray<FString>& OutBatch);
+
+	/** Lets a walk be consumed with a range-based for loop, one batch per iteration. */
+	class FBatchIterator
+	{
+
+	public:
+		explicit FBatchIterator(DirectoryEnumerator* InEnumerator) : Enumerator(InEnumerator) { ++(*this); }
+
+		FBatchIterator& operator++()
+		{
+			if (Enumerator && !Enumerator->NextBatch(Batch))
+			{
+				Enumerator = nullptr;
+			}
+			return *this;
+		}
+
+		const TArray<FString>& operator*() const { return Batch; }
+		bool operator!=(const FBatchIterator& Other) const { return Enumerator != Other.Enumerator; }
+
+	private:
+		DirectoryEnumerator* Enumerator;
+		TArray<FString> Batch;
+	};
+
+	FBatchIterator begin() { return FBatchIterator(this); }
+	FBatchIterator end() { return FBatchIterator(nullptr); }
+
+private:
+	/** Lists the next pending directory into PendingFiles. Returns false when no directory is left. */
+	bool ListNextDirectory();
+
+	FString Extension;
+	bool bRecursive;
+	bool bOnlyFilenames;
+	int32 BatchSize;
+
+	// Directories still to list (depth first), and the files of the last listed directory not handed out yet.
+	// Memory is bounded by the largest single directory rather than by the whole tree.
+	TArray<FString> PendingDirectories;
+	TArray<FString> PendingFiles;
+	int32 NextPendingFile = 0;
+};
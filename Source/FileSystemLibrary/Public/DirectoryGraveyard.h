@@ -0,0 +1,24 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for deleting directories in the background. A directory is first renamed into a graveyard on the
+// same volume, which is instant, then its content is deleted by a low priority thread.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FILESYSTEMLIBRARY_API DirectoryGraveyard
+{
+
+public:
+	/** Moves PathToDirectory out of the way and queues it for deletion. If it can't be renamed (e.g. it is a mount point) it is deleted synchronously.
+	 * Returns true once nothing is left at PathToDirectory.
+	 */
+	static bool Bury(const FString& PathToDirectory);
+
+	/** Queues the graveyards left over by a previous run, called when the module starts. */
+	static void PurgeLeftovers();
+
+	/** Stops the purge thread, unfinished graveyards are purged on the next start. */
+	static void Shutdown();
+};
@@ -0,0 +1,49 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for listing a directory together with the metadata of every entry in a single pass.
+// Each field lives in its own array (structure of arrays), so sorting or scanning one column doesn't drag the others through the cache.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FILESYSTEMLIBRARY_API DirectoryListing
+{
+
+public:
+	enum EEntryFlags : uint8
+	{
+		Directory = 1 << 0,
+		ReadOnly = 1 << 1
+	};
+
+	/** Lists PathToDirectory (and its sub-directories with bRecursive) with IterateDirectoryStat, one stat per entry is all it costs. */
+	static TSharedRef<DirectoryListing, ESPMode::ThreadSafe> Create(const FString& PathToDirectory, bool bRecursive);
+
+	int32 Num() const { return Sizes.Num(); }
+
+	/** Path of the entry relative to the listed directory. */
+	FString GetRelativePath(int32 Index) const
+	{
+		return FString(NameOffsets[Index + 1] - NameOffsets[Index], Names.GetData() + NameOffsets[Index]);
+	}
+
+	const FString& GetRootPath() const { return RootPath; }
+
+	bool IsDirectory(int32 Index) const { return (Flags[Index] & Directory) != 0; }
+	bool IsReadOnly(int32 Index) const { return (Flags[Index] & ReadOnly) != 0; }
+
+	FString RootPath;
+
+	// One element per entry in each of the arrays below, in listing order
+
+	// Relative paths of every entry, back to back; entry I is [NameOffsets[I], NameOffsets[I + 1])
+	TArray<TCHAR> Names;
+	TArray<int32> NameOffsets;
+
+	TArray<int64> Sizes;
+	TArray<FDateTime> CreationTimes;
+	TArray<FDateTime> AccessTimes;
+	TArray<FDateTime> ModificationTimes;
+	TArray<uint8> Flags;
+};
@@ -0,0 +1,29 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for computing the total size of directory trees ("du"), in parallel and with 64-bit totals.
+// What a directory directly contains is cached against its modification time, so asking again only re-lists directories that changed.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDirectorySizeStats
+{
+	FString Path;
+	int64 SizeBytes = 0;
+	int64 NumFiles = 0;
+};
+
+class FILESYSTEMLIBRARY_API DirectorySizeManager
+{
+
+public:
+	/** Sums the size of every file below PathToDirectory on at most MaxConcurrency workers (0 uses every hardware thread).
+	 * OutSubDirectories, if given, receives the totals of each direct sub-directory, largest first.
+	 * With bUseCache, directories whose modification time didn't change since the last query aren't listed again. A directory's time
+	 * changes when entries are added, removed or renamed, not when a file in it is rewritten in place: pass false to pick those up.
+	 */
+	static bool ComputeSize(const FString& PathToDirectory, int32 MaxConcurrency, bool bUseCache, FDirectorySizeStats& OutTotal, TArray<FDirectorySizeStats>* OutSubDirectories = nullptr);
+
+	static void ClearCache();
+};
@@ -0,0 +1,64 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for reading directories and walking directory trees in parallel.
+// Platforms with a faster way to read directory entries override ReadDirectory.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class CompactPathList;
+class FileFilter;
+
+class FILESYSTEMLIBRARY_API DirectoryWalkManager
+{
+
+public:
+	/** Receives the name (not the path) of an entry and whether it is a directory. */
+	typedef TFunctionRef<void(const TCHAR* Name, bool bIsDirectory)> FEntryVisitor;
+
+	/** Receives every entry of the walk with the index of the worker that found it (below the MaxConcurrency given to Walk)
+	 * and the directory it is in. Returning false for a directory skips its content.
+	 */
+	typedef TFunctionRef<bool(int32 WorkerIndex, const FString& Directory, const TCHAR* Name, bool bIsDirectory)> FWalkVisitor;
+
+	DirectoryWalkManager();
+	virtual ~DirectoryWalkManager();
+
+	/** Calls Visitor for every entry of PathToDirectory, "." and ".." excluded. Safe to call from any thread. Returns false if the directory can't be read. */
+	virtual bool ReadDirectory(const FString& PathToDirectory, FEntryVisitor Visitor);
+
+	/** Visits PathToDirectory and, with bRecursive, every directory below it. Each directory is one task on a work-stealing pool
+	 * of GetNumWorkers(MaxConcurrency) workers, so slow directory reads overlap. Returns false if PathToDirectory can't be read.
+	 */
+	bool Walk(const FString& PathToDirectory, bool bRecursive, int32 MaxConcurrency, FWalkVisitor Visitor);
+
+	/** Same result as IPlatformFile::FindFiles / FindFilesRecursively, built on Walk. The appended files are sorted by path. */
+	bool FindFiles(TArray<FString>& OutFiles, const FString& PathToDirectory, const FString& ExtensionFilter, bool bRecursive, int32 MaxConcurrency = 0);
+
+	/** Appends the files below PathToDirectory that pass Filter. Filter is evaluated during the walk: excluded directories are never opened,
+	 * and only files passing the name rules are stat'ed (when the filter has size or time rules) or turned into paths.
+	 * The appended files are sorted by path, so the order doesn't depend on how the walk was split between workers.
+	 */
+	bool FindFiles(TArray<FString>& OutFiles, const FString& PathToDirectory, const FileFilter& Filter, bool bRecursive, int32 MaxConcurrency = 0);
+
+	/** Same as above, but replaces OutFiles with a CompactPathList rooted at PathToDirectory (an order of magnitude less memory on large trees).
+	 * The files are sorted by directory, then by name.
+	 */
+	bool FindFiles(CompactPathList& OutFiles, const FString& PathToDirectory, const FileFilter& Filter, bool bRecursive, int32 MaxConcurrency = 0);
+
+	/** Number of workers Walk uses for MaxConcurrency, 0 or less means every hardware thread. */
+	static int32 GetNumWorkers(int32 MaxConcurrency);
+
+	/** Turns "*.txt", "txt" or ".txt" into ".txt", empty stays empty. */
+	static FString NormalizeExtensionFilter(const FString& ExtensionFilter);
+
+	/** Returns the walk manager for the current platform. */
+	static DirectoryWalkManager& Get();
+
+private:
+	typedef TFunctionRef<void(int32 WorkerIndex, const FString& Directory, const TCHAR* Name)> FFileVisitor;
+
+	/** Walks with Filter applied, OnFile only sees the files that pass it. */
+	bool WalkMatchingFiles(const FString& PathToDirectory, const FileFilter& Filter, bool bRecursive, int32 NumWorkers, FFileVisitor OnFile);
+};
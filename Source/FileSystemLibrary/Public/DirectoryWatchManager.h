@@ -0,0 +1,48 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for watching a directory for changes. Platforms with a native change notification API override it,
+// the base class doesn't support watching.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EDirectoryChangeType : uint8
+{
+	Added,
+	Modified,
+	Removed,
+	// Path is the new name, OldPath the previous one
+	Renamed,
+	// The platform dropped events, Path must be rescanned
+	Overflow
+};
+
+struct FDirectoryChange
+{
+	FString Path;
+	FString OldPath;
+	EDirectoryChangeType Type;
+};
+
+class FILESYSTEMLIBRARY_API DirectoryWatchManager
+{
+
+public:
+	/** Receives the coalesced changes of one burst. Called from the watch thread. */
+	typedef TFunction<void(TArray<FDirectoryChange>&& Changes)> FChangesCallback;
+
+	DirectoryWatchManager();
+	virtual ~DirectoryWatchManager();
+
+	/** Starts watching PathToDirectory. Changes are gathered until no new one arrived for DebounceSeconds,
+	 * merged per path (e.g. added then modified is reported once as added) and handed to OnChanges in one array.
+	 */
+	virtual bool StartWatching(const FString& PathToDirectory, bool bRecursive, double DebounceSeconds, FChangesCallback OnChanges);
+
+	/** Stops watching, pending changes are dropped. */
+	virtual void StopWatching();
+
+	/** Returns a watch manager for the current platform. */
+	static TUniquePtr<DirectoryWatchManager> Create();
+};
@@ -0,0 +1,52 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for appending and inserting lines in text files. Only the new bytes (and for inserts, the lines after them)
+// are written, in the encoding the file already uses, and frequent small appends can be queued per file and written in one go
+// once enough text or time has accumulated.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FILESYSTEMLIBRARY_API FileAppendManager
+{
+
+public:
+	static const int64 DefaultFlushSizeBytes = 64 * 1024;
+	static constexpr double DefaultFlushIntervalSeconds = 1.0;
+
+	/** Appends Lines to the end of PathToFile, each followed by a line break, without reading the existing content.
+	 * The text is written as UTF-16 if the file has a UTF-16 BOM and as UTF-8 otherwise. A missing file is created the way
+	 * FFileHelper::SaveStringArrayToFile would create it. Lines queued for the file are written first.
+	 */
+	static bool AppendLines(const FString& PathToFile, const TArray<FString>& Lines);
+
+	/** Writes Lines before the content of PathToFile. The file has to be rewritten, it is streamed into a temporary file next to it
+	 * (so memory stays bounded) which then replaces the original.
+	 */
+	static bool PrependLines(const FString& PathToFile, const TArray<FString>& Lines);
+
+	/** Inserts Lines before line AtLine of PathToFile (appends them past the last line). Only the content after that line is moved,
+	 * in blocks, from the end of the file backwards. With bUseLineIndex the line is found through the file's saved line index
+	 * (see MappedTextFile), which is then updated rather than rebuilt; otherwise the lines are scanned and nothing is saved.
+	 * The file is edited in place: if writing fails midway it is left damaged.
+	 */
+	static bool InsertLines(const FString& PathToFile, int32 AtLine, const TArray<FString>& Lines, bool bUseLineIndex = false);
+
+	/** Queues Lines to be appended to PathToFile. They are written once the queue of that file holds more than the flush size,
+	 * once the oldest queued line is older than the flush interval, on Flush, or when the module shuts down.
+	 * The size flush happens on the calling thread, the timed flush on the thread pool.
+	 */
+	static void QueueLines(const FString& PathToFile, const TArray<FString>& Lines);
+
+	/** Writes the lines queued for PathToFile now. Returns false if they couldn't be written, they are dropped. */
+	static bool Flush(const FString& PathToFile);
+
+	/** Writes the lines queued for every file now. */
+	static bool FlushAll();
+
+	static void SetFlushThresholds(int64 FlushSizeBytes, double FlushIntervalSeconds);
+
+	/** Stops the flush timer and writes everything still queued, called when the module shuts down. */
+	static void Shutdown();
+};
@@ -0,0 +1,92 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for copying and moving files. Platforms with faster copy primitives override CopyFile.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+
+enum class EFileCopyResult : uint8
+{
+	Success,
+	Failed,
+	Cancelled
+};
+
+enum class EFileMoveResult : uint8
+{
+	// Moved with a single rename on the same volume
+	Renamed,
+	// Copied to the other volume, the source is deleted afterwards
+	CopiedAndDeleted,
+	Failed
+};
+
+struct FDirectoryCopyStats
+{
+	int64 FilesCopied = 0;
+	int64 FilesSkipped = 0;
+	int64 BytesCopied = 0;
+	int64 Failures = 0;
+	double Seconds = 0.0;
+};
+
+struct FDirectorySyncStats
+{
+	int64 FilesCopied = 0;
+	int64 FilesSkipped = 0;
+	int64 FilesDeleted = 0;
+	int64 BytesCopied = 0;
+	int64 BytesSkipped = 0;
+	int64 Failures = 0;
+	double Seconds = 0.0;
+};
+
+class FILESYSTEMLIBRARY_API FileCopyManager
+{
+
+public:
+	/** Called after every chunk with the number of bytes written so far and the size of the source file. */
+	typedef TFunction<void(int64 BytesCopied, int64 TotalBytes)> FProgressCallback;
+
+	/** Chunks are sized and allocated on this boundary so reads and writes stay page aligned. */
+	static const int64 CopyAlignment = 4096;
+	static const int64 DefaultChunkSize = 8 * 1024 * 1024;
+
+	FileCopyManager();
+	virtual ~FileCopyManager();
+
+	/** Copies PathToFile to DestinationFilePath in ChunkSize blocks. Safe to call from any thread.
+	 * If CancelFlag is raised between two chunks the partial destination file is deleted and Cancelled is returned.
+	 */
+	virtual EFileCopyResult CopyFile(const FString& PathToFile, const FString& DestinationFilePath, const FThreadSafeBool* CancelFlag = nullptr, const FProgressCallback& OnProgress = FProgressCallback(), int64 ChunkSize = DefaultChunkSize);
+
+	/** Copies the content of PathToDirectory into NewPathToDirectory. Directory discovery and file copies are tasks on a work-stealing pool
+	 * of at most MaxConcurrency workers (0 uses every hardware thread). Existing files are only replaced when bOverwrite is true.
+	 * Returns false if any directory or file failed to copy, no new work is started after the first failure.
+	 */
+	bool CopyDirectory(const FString& PathToDirectory, const FString& NewPathToDirectory, bool bOverwrite, int32 MaxConcurrency, FDirectoryCopyStats& OutStats);
+
+	/** Makes NewPathToDirectory a mirror of PathToDirectory by copying only files that are missing or changed.
+	 * A file is unchanged when its size and modification time match (within 2 seconds, to tolerate coarse file systems);
+	 * with bCompareContent, files of equal size are compared by content hash instead of modification time.
+	 * Copied files get the modification time of their source so the next sync skips them.
+	 * With bDeleteOrphans, files and directories that only exist in the destination are deleted.
+	 */
+	bool SyncDirectory(const FString& PathToDirectory, const FString& NewPathToDirectory, bool bDeleteOrphans, bool bCompareContent, int32 MaxConcurrency, FDirectorySyncStats& OutStats);
+
+	/** Moves a file. A same-volume move is a single rename, a cross-volume move is a chunked copy followed by deleting the source. */
+	EFileMoveResult MoveFile(const FString& PathToFile, const FString& DestinationFilePath);
+
+	/** Moves a directory. When both paths are on the same volume and NewPathToDirectory doesn't exist yet (or is empty) the directory is renamed.
+	 * Otherwise the content is merged into NewPathToDirectory with CopyDirectory and the source is buried with DirectoryGraveyard.
+	 */
+	EFileMoveResult MoveDirectory(const FString& PathToDirectory, const FString& NewPathToDirectory, bool bOverwrite);
+
+	/** Whether two paths live on the same volume, i.e. whether a rename between them can succeed. Paths that don't exist yet are resolved to their closest existing parent. */
+	bool IsSameVolume(const FString& PathA, const FString& PathB) const;
+
+	/** Returns the copy manager for the current platform. */
+	static FileCopyManager& Get();
+};
@@ -0,0 +1,87 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for deciding, during a directory walk, which files are returned and which directories are entered.
+// Patterns are compiled once so evaluating an entry never allocates.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FFileFilterRules
+{
+	/** Glob patterns a file has to match one of (all files if empty). Patterns without a '/' match the file name,
+	 * patterns with one match the path relative to the walked directory. '*' and '?' stop at '/', "**" doesn't.
+	 */
+	TArray<FString> Include;
+	/** Files matching any of these are left out. */
+	TArray<FString> Exclude;
+	/** Directories matching any of these are never opened, nor anything below them. */
+	TArray<FString> ExcludeDirectories;
+
+	/** Size range in bytes, inclusive. Negative means no bound. */
+	int64 MinSizeBytes = -1;
+	int64 MaxSizeBytes = -1;
+
+	/** Modification time range, inclusive. */
+	FDateTime ModifiedAfter = FDateTime::MinValue();
+	FDateTime ModifiedBefore = FDateTime::MaxValue();
+};
+
+class FILESYSTEMLIBRARY_API FileFilter
+{
+
+public:
+	/** RootDirectory is the directory the walk starts from, path patterns are relative to it. */
+	FileFilter(const FString& RootDirectory, const FFileFilterRules& Rules);
+
+	/** Whether the walk should open the sub-directory Name of Directory. */
+	bool ShouldEnterDirectory(const FString& Directory, const TCHAR* Name) const;
+
+	/** Whether the file Name in Directory passes the name rules. The size and time rules are checked separately, see NeedsStat. */
+	bool MatchesName(const FString& Directory, const TCHAR* Name) const;
+
+	/** Whether MatchesStat has to be called, i.e. whether a size or time rule is set. */
+	bool NeedsStat() const { return bNeedsStat; }
+	bool MatchesStat(int64 Size, const FDateTime& ModificationTime) const;
+
+	/** Matches Text against a single glob pattern, ignoring case. */
+	static bool MatchesGlob(const TCHAR* Pattern, const TCHAR* Text);
+
+private:
+	struct FCompiledPattern
+	{
+		enum class EKind : uint8
+		{
+			// No wildcard
+			Literal,
+			// "*.ext" and the like, a suffix compare
+			Suffix,
+			// "name*", a prefix compare
+			Prefix,
+			Glob
+		};
+
+		EKind Kind;
+		bool bMatchesPath;
+		// The pattern, or the literal part of a Suffix/Prefix pattern
+		FString Text;
+	};
+
+	static TArray<FCompiledPattern> Compile(const TArray<FString>& Patterns, bool& bOutAnyPathPattern);
+	bool MatchesAny(const TArray<FCompiledPattern>& Patterns, bool bAnyPathPattern, const FString& Directory, const TCHAR* Name) const;
+
+	int32 RootLength;
+
+	TArray<FCompiledPattern> Include;
+	TArray<FCompiledPattern> Exclude;
+	TArray<FCompiledPattern> ExcludeDirectories;
+	bool bIncludeHasPaths = false;
+	bool bExcludeHasPaths = false;
+	bool bExcludeDirectoriesHasPaths = false;
+
+	bool bNeedsStat;
+	int64 MinSizeBytes;
+	int64 MaxSizeBytes;
+	FDateTime ModifiedAfter;
+	FDateTime ModifiedBefore;
+};
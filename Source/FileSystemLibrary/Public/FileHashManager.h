@@ -0,0 +1,49 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for fingerprinting file contents. Files are streamed through the hasher, they are never loaded whole.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EFileHashType : uint8
+{
+	// 64-bit XXH3, the fastest option for change detection
+	XxHash3,
+	// 256-bit BLAKE3, cryptographic strength
+	Blake3
+};
+
+class FILESYSTEMLIBRARY_API FileHashManager
+{
+
+public:
+	/** Size of each read while hashing. */
+	static const int64 HashBufferSize = 1024 * 1024;
+
+	/** Returns the lowercase hex hash of Length bytes of the file starting at Offset (Length < 0 hashes to the end of the file), or an empty string if the file can't be read. */
+	static FString HashFile(const FString& PathToFile, EFileHashType HashType, int64 Offset = 0, int64 Length = -1);
+
+	/** Hashes every file on at most MaxConcurrency threads (0 uses every hardware thread). OutHashes matches Files, with empty strings for unreadable files. */
+	static void HashFiles(const TArray<FString>& Files, EFileHashType HashType, int32 MaxConcurrency, TArray<FString>& OutHashes);
+
+	/** Hashes every file under PathToDirectory. OutRelativePaths is sorted and relative to PathToDirectory, OutHashes matches it. Returns false if any file couldn't be read. */
+	static bool HashDirectory(const FString& PathToDirectory, EFileHashType HashType, int32 MaxConcurrency, TArray<FString>& OutRelativePaths, TArray<FString>& OutHashes);
+
+	/** Writes a manifest with one "<hash>  <relative path>" line per file, after a header line naming the hash type. */
+	static bool WriteManifest(const FString& ManifestPath, EFileHashType HashType, const TArray<FString>& RelativePaths, const TArray<FString>& Hashes);
+
+	/** Re-hashes every file listed in the manifest against PathToDirectory. Returns true if the manifest could be read and every file matched. */
+	static bool VerifyManifest(const FString& PathToDirectory, const FString& ManifestPath, int32 MaxConcurrency, TArray<FString>& OutChangedFiles, TArray<FString>& OutMissingFiles);
+
+	/** Bytes hashed at each end of a file when pre-filtering duplicate candidates. */
+	static const int64 PartialHashSize = 64 * 1024;
+
+	/** Groups identical files. Files are bucketed by size, then by a hash of their first and last PartialHashSize bytes,
+	 * and only files still sharing a bucket are hashed in full. Empty files are ignored. Each group holds at least two paths,
+	 * OutFileSizes holds the size of the files of each group.
+	 */
+	static void FindDuplicateFiles(const TArray<FString>& Files, int32 MaxConcurrency, TArray<TArray<FString>>& OutGroups, TArray<int64>& OutFileSizes);
+
+	static const TCHAR* GetHashTypeName(EFileHashType HashType);
+};
@@ -0,0 +1,85 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for searching file names by substring or approximately, without scanning every name.
+// Every name is broken into trigrams (three consecutive characters); a query only looks at the names sharing its trigrams.
+// Searches and updates can come from any thread, they are guarded by a read/write lock.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+
+class FILESYSTEMLIBRARY_API FileNameIndex
+{
+
+public:
+	/** Replaces the content of the index with every file below PathToDirectory. Files added or removed while the walk runs are
+	 * replayed on top of its result, and a build that finishes after a later one is discarded.
+	 */
+	bool Build(const FString& PathToDirectory, int32 MaxConcurrency = 0);
+
+	/** Adds or removes a single file, e.g. from directory watcher events. */
+	void AddFile(const FString& Path);
+	void RemoveFile(const FString& Path);
+
+	/** Adds every file below PathToDirectory / removes every indexed file below it. */
+	void AddDirectory(const FString& PathToDirectory);
+	void RemoveDirectory(const FString& PathToDirectory);
+
+	/** Returns the paths of up to MaxResults files whose name contains Query, ignoring case. */
+	void SearchSubstring(const FString& Query, int32 MaxResults, TArray<FString>& OutPaths) const;
+
+	/** Returns the paths of up to MaxResults files whose name is closest to Query (most trigrams in common, relative to both lengths),
+	 * best first. Tolerates typos and swapped words, e.g. "tex_rock" finds "T_Rock_Texture".
+	 */
+	void SearchFuzzy(const FString& Query, int32 MaxResults, TArray<FString>& OutPaths) const;
+
+	/** Returned by value, a concurrent Build may replace it. */
+	FString GetRootPath() const;
+	int32 Num() const;
+
+private:
+	/** Appends the distinct trigrams of LowerText, each packed into a 64-bit key. */
+	static void GetTrigrams(const FString& LowerText, TArray<uint64>& OutTrigrams);
+
+	void AddFileLocked(const FString& Path);
+	void RemoveFileLocked(const FString& Path);
+	void RemoveDirectoryLocked(const FString& Prefix);
+
+	/** Replaces the content with Files, then replays the updates recorded since the walk that found them started. */
+	void ApplyBuildLocked(const FString& PathToDirectory, const TArray<FString>& Files, int32 FirstPendingChange);
+
+	/** Keeps an update for the builds in flight, their walk may have missed it. */
+	void RecordPendingLocked(const FString& Path, bool bAdded, bool bDirectory);
+
+	/** Rebuilds the postings once more than half of the entries are removed ones. */
+	void CompactLocked();
+
+	FString RootPath;
+
+	mutable FRWLock Lock;
+
+	// One element per entry in each array, removed entries stay until the next compaction
+	TArray<FString> Paths;
+	TArray<FString> LowerNames;
+	TArray<uint16> NumTrigrams;
+	TBitArray<> Alive;
+
+	TMap<FString, int32> PathIds;
+	// Sorted ids of the entries containing each trigram
+	TMap<uint64, TArray<int32>> Postings;
+	int32 NumRemoved = 0;
+
+	struct FPendingChange
+	{
+		FString Path;
+		bool bAdded;
+		bool bDirectory;
+	};
+
+	// Updates made while at least one build walks, in order
+	TArray<FPendingChange> PendingChanges;
+	int32 NumBuildsInFlight = 0;
+	uint64 NumBuildsStarted = 0;
+	uint64 LastBuildApplied = 0;
+};
@@ -0,0 +1,35 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for answering sorted, limited queries over a directory tree ("the 500 largest files", "page 3 by date")
+// while walking it. Only the best Offset + Limit files are ever kept, in bounded heaps, so no full listing is built or sorted.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FileFilter;
+
+enum class EFileSortKey : uint8
+{
+	Size,
+	ModificationTime,
+	// Sorts on the full path, which is the file name within a single directory
+	Name
+};
+
+struct FFileQueryEntry
+{
+	FString Path;
+	int64 Size = 0;
+	FDateTime ModificationTime;
+};
+
+class FILESYSTEMLIBRARY_API FileQueryManager
+{
+
+public:
+	/** Walks PathToDirectory with Filter applied and returns the files ranked [Offset, Offset + Limit) by SortKey, ascending or descending.
+	 * Ties are broken by path so pages are stable. OutTotalMatches receives the number of files that passed the filter.
+	 */
+	static bool Query(const FString& PathToDirectory, const FileFilter& Filter, bool bRecursive, EFileSortKey SortKey, bool bDescending, int32 Offset, int32 Limit, int32 MaxConcurrency, TArray<FFileQueryEntry>& OutEntries, int64& OutTotalMatches);
+};
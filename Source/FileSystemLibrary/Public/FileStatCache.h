@@ -0,0 +1,35 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for caching file and directory stat data, so repeated existence and property checks on the same
+// path cost a single file system call. The cache is off by default; when off every lookup goes straight to the platform.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+class FILESYSTEMLIBRARY_API FileStatCache
+{
+
+public:
+	/** Entries older than TimeToLiveSeconds are refreshed on their next lookup. Disabling the cache also clears it. */
+	static void SetEnabled(bool bEnabled, double TimeToLiveSeconds = 1.0);
+	static bool IsEnabled();
+
+	/** Returns the stat data of Path. bIsValid is false if the path doesn't exist, missing paths are cached too. */
+	static FFileStatData GetStatData(const FString& Path);
+
+	/** Forgets Path. Call after creating, modifying or deleting it. */
+	static void Invalidate(const FString& Path);
+
+	/** Forgets Path and every directory above it, call after creating a path whose parents may have been created too. */
+	static void InvalidatePathAndParents(const FString& Path);
+
+	/** Forgets PathToDirectory and everything under it. */
+	static void InvalidateDirectory(const FString& PathToDirectory);
+
+	static void Clear();
+
+	static void GetCounters(int64& OutHits, int64& OutMisses);
+	static void ResetCounters();
+};
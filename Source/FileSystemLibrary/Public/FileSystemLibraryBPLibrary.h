@@ -12,6 +12,25 @@
 #include <string>
 
 #include "DialogManager.h"
+#include "FileCopyManager.h"
+#include "FileHashManager.h"
+#include "DirectoryGraveyard.h"
+#include "FileStatCache.h"
+#include "DirectoryWatchManager.h"
+#include "ParallelFileWork.h"
+#include "DirectoryEnumerator.h"
+#include "DirectoryWalkManager.h"
+#include "FileFilter.h"
+#include "DirectoryListing.h"
+#include "DirectorySizeManager.h"
+#include "CompactPathList.h"
+#include "FileQueryManager.h"
+#include "FileNameIndex.h"
+#include "ContentSearchManager.h"
+#include "MappedTextFile.h"
+#include "LineStreamReader.h"
+#include "FileAppendManager.h"
+#include "PersistentFileIndex.h"
 #if PLATFORM_WINDOWS
 #include "Win/DialogManagerWin.h"
 #endif
@@ -48,7 +67,7 @@ struct FILESYSTEMLIBRARY_API FPathProperties
 	FDateTime ModificationDate;
 
 	UPROPERTY(BlueprintReadOnly, Category = "PathProperties")
-	int FileSizeBytes;
+	int64 FileSizeBytes;
 
 	UPROPERTY(BlueprintReadOnly, Category = "PathProperties")
 	bool isDirectory;
@@ -71,12 +90,449 @@ struct FILESYSTEMLIBRARY_API FPathProperties
 		CreationDate = inCreationDate;
 		AccessDate = inAccessDate;
 		ModificationDate = inModificationDate;
-		FileSizeBytes = int(inFileSizeBytes);
+		FileSizeBytes = inFileSizeBytes;
 		isDirectory = inIsDirectory;
 		isReadOnly = inIsReadOnly;
 	}
 };
 
+UENUM(BlueprintType)
+enum class EFileOperationType : uint8
+{
+	Copy,
+	Move,
+	Delete
+};
+
+UENUM(BlueprintType)
+enum class EFileMoveMethod : uint8
+{
+	// Same volume, moved with a single rename
+	Rename,
+	// Different volume (or non-empty destination directory), copied then deleted
+	CopyAndDelete,
+	Failed
+};
+
+UENUM(BlueprintType)
+enum class EFileHashAlgorithm : uint8
+{
+	// Fast 64-bit hash, best for change detection
+	XxHash3,
+	// 256-bit cryptographic hash
+	Blake3
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FFileOperation
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileOperation")
+	EFileOperationType Operation;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileOperation")
+	FString PathToFile;
+
+	// Ignored for Delete
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileOperation")
+	FString DestinationFilePath;
+
+	FFileOperation()
+	{
+		Operation = EFileOperationType::Copy;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FFileOperationResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+	bool Succeeded;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+	float DurationSeconds;
+
+	FFileOperationResult()
+	{
+		Succeeded = false;
+		DurationSeconds = 0.f;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FFileOperationBatchSummary
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+	int SucceededCount;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+	int FailedCount;
+
+	// Wall clock time of the whole batch
+	UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+	float TotalSeconds;
+
+	// Sum of the individual operation durations, compare with TotalSeconds to see how much the workers overlapped
+	UPROPERTY(BlueprintReadOnly, Category = "FileOperation")
+	float CumulativeSeconds;
+
+	FFileOperationBatchSummary()
+	{
+		SucceededCount = 0;
+		FailedCount = 0;
+		TotalSeconds = 0.f;
+		CumulativeSeconds = 0.f;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FDirectoryCopyResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectoryCopy")
+	int64 FilesCopied;
+
+	// Files left untouched because they already existed and AllowOvewrite was false
+	UPROPERTY(BlueprintReadOnly, Category = "DirectoryCopy")
+	int64 FilesSkipped;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectoryCopy")
+	int64 BytesCopied;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectoryCopy")
+	float Seconds;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectoryCopy")
+	float FilesPerSecond;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectoryCopy")
+	float BytesPerSecond;
+
+	FDirectoryCopyResult()
+	{
+		FilesCopied = 0;
+		FilesSkipped = 0;
+		BytesCopied = 0;
+		Seconds = 0.f;
+		FilesPerSecond = 0.f;
+		BytesPerSecond = 0.f;
+	}
+
+	FDirectoryCopyResult(const FDirectoryCopyStats& Stats)
+	{
+		FilesCopied = Stats.FilesCopied;
+		FilesSkipped = Stats.FilesSkipped;
+		BytesCopied = Stats.BytesCopied;
+		Seconds = float(Stats.Seconds);
+		FilesPerSecond = Stats.Seconds > 0.0 ? float(Stats.FilesCopied / Stats.Seconds) : 0.f;
+		BytesPerSecond = Stats.Seconds > 0.0 ? float(Stats.BytesCopied / Stats.Seconds) : 0.f;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FDirectorySyncSummary
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySync")
+	int64 FilesCopied;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySync")
+	int64 FilesSkipped;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySync")
+	int64 FilesDeleted;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySync")
+	int64 BytesCopied;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySync")
+	int64 BytesSkipped;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySync")
+	int64 Failures;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySync")
+	float Seconds;
+
+	FDirectorySyncSummary()
+	{
+		FilesCopied = 0;
+		FilesSkipped = 0;
+		FilesDeleted = 0;
+		BytesCopied = 0;
+		BytesSkipped = 0;
+		Failures = 0;
+		Seconds = 0.f;
+	}
+
+	FDirectorySyncSummary(const FDirectorySyncStats& Stats)
+	{
+		FilesCopied = Stats.FilesCopied;
+		FilesSkipped = Stats.FilesSkipped;
+		FilesDeleted = Stats.FilesDeleted;
+		BytesCopied = Stats.BytesCopied;
+		BytesSkipped = Stats.BytesSkipped;
+		Failures = Stats.Failures;
+		Seconds = float(Stats.Seconds);
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FDuplicateFileGroup
+{
+	GENERATED_BODY()
+
+	// Paths of files with identical content
+	UPROPERTY(BlueprintReadOnly, Category = "DuplicateFiles")
+	TArray<FString> Files;
+
+	// Size of each file of the group
+	UPROPERTY(BlueprintReadOnly, Category = "DuplicateFiles")
+	int64 FileSizeBytes;
+
+	FDuplicateFileGroup()
+	{
+		FileSizeBytes = 0;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FDirectorySize
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySize")
+	FString Path;
+
+	// Total size of every file below the directory
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySize")
+	int64 SizeBytes;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectorySize")
+	int64 FileCount;
+
+	FDirectorySize()
+	{
+		SizeBytes = 0;
+		FileCount = 0;
+	}
+
+	FDirectorySize(const FDirectorySizeStats& Stats)
+	{
+		Path = Stats.Path;
+		SizeBytes = Stats.SizeBytes;
+		FileCount = Stats.NumFiles;
+	}
+};
+
+UENUM(BlueprintType)
+enum class EFileQuerySortKey : uint8
+{
+	Size,
+	ModificationTime,
+	// Full path, which is the file name within a single directory
+	Name
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FFileQueryResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "FileQuery")
+	FString Path;
+
+	// Size and date are only filled when sorting by size or modification time, or when the filter has size or modification time rules
+	UPROPERTY(BlueprintReadOnly, Category = "FileQuery")
+	int64 FileSizeBytes;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FileQuery")
+	FDateTime ModificationDate;
+
+	FFileQueryResult()
+	{
+		FileSizeBytes = 0;
+		ModificationDate = FDateTime::MinValue();
+	}
+
+	FFileQueryResult(const FFileQueryEntry& Entry)
+	{
+		Path = Entry.Path;
+		FileSizeBytes = Entry.Size;
+		ModificationDate = Entry.ModificationTime;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FContentSearchHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "ContentSearch")
+	FString Path;
+
+	// Starts at 1
+	UPROPERTY(BlueprintReadOnly, Category = "ContentSearch")
+	int Line;
+
+	// Starts at 1
+	UPROPERTY(BlueprintReadOnly, Category = "ContentSearch")
+	int Column;
+
+	// The line containing the match
+	UPROPERTY(BlueprintReadOnly, Category = "ContentSearch")
+	FString LineText;
+
+	FContentSearchHit()
+	{
+		Line = 0;
+		Column = 0;
+	}
+
+	FContentSearchHit(const FContentSearchMatch& Match)
+	{
+		Path = Match.Path;
+		Line = Match.Line;
+		Column = Match.Column;
+		LineText = Match.LineText;
+	}
+};
+
+UENUM(BlueprintType)
+enum class EDirectoryChangeKind : uint8
+{
+	Added,
+	Modified,
+	Removed,
+	// Path holds the new name and OldPath the previous one
+	Renamed,
+	// Some changes were lost, the directory at Path should be listed again
+	Overflow
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FDirectoryChangeEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectoryWatcher")
+	FString Path;
+
+	// Only set for Renamed
+	UPROPERTY(BlueprintReadOnly, Category = "DirectoryWatcher")
+	FString OldPath;
+
+	UPROPERTY(BlueprintReadOnly, Category = "DirectoryWatcher")
+	EDirectoryChangeKind Change;
+
+	FDirectoryChangeEvent()
+	{
+		Change = EDirectoryChangeKind::Modified;
+	}
+
+	FDirectoryChangeEvent(const FDirectoryChange& InChange)
+	{
+		Path = InChange.Path;
+		OldPath = InChange.OldPath;
+		Change = EDirectoryChangeKind(InChange.Type);
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FFileFilterSpec
+{
+	GENERATED_BODY()
+
+	// Glob patterns ("*.png", "Textures/**/*.tga"), a file has to match one of them. Empty returns every file.
+	// Patterns without a '/' match the file name, patterns with one match the path relative to the searched directory.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileFilter")
+	TArray<FString> Include;
+
+	// Files matching any of these patterns are left out
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileFilter")
+	TArray<FString> Exclude;
+
+	// Directories matching any of these patterns ("Intermediate", ".git") are skipped with everything below them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileFilter")
+	TArray<FString> ExcludeDirectories;
+
+	// Inclusive size range in bytes, negative for no bound
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileFilter")
+	int64 MinSizeBytes;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileFilter")
+	int64 MaxSizeBytes;
+
+	// Only used when UseModificationRange is set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileFilter")
+	bool UseModificationRange;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileFilter")
+	FDateTime ModifiedAfter;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FileFilter")
+	FDateTime ModifiedBefore;
+
+	FFileFilterSpec()
+	{
+		MinSizeBytes = -1;
+		MaxSizeBytes = -1;
+		UseModificationRange = false;
+		ModifiedAfter = FDateTime::MinValue();
+		ModifiedBefore = FDateTime::MaxValue();
+	}
+
+	FFileFilterRules ToRules() const
+	{
+		FFileFilterRules Rules;
+		Rules.Include = Include;
+		Rules.Exclude = Exclude;
+		Rules.ExcludeDirectories = ExcludeDirectories;
+		Rules.MinSizeBytes = MinSizeBytes;
+		Rules.MaxSizeBytes = MaxSizeBytes;
+		if (UseModificationRange)
+		{
+			Rules.ModifiedAfter = ModifiedAfter;
+			Rules.ModifiedBefore = ModifiedBefore;
+		}
+		return Rules;
+	}
+};
+
+/* Result of ListDirectoryWithProperties. Read it with GetListingNum and GetListingEntry, copying it around is free. */
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FDirectoryListingSnapshot
+{
+	GENERATED_BODY()
+
+	TSharedPtr<DirectoryListing, ESPMode::ThreadSafe> Listing;
+};
+
+/* Result of GetFilesCompact. Paths are stored once per directory and rebuilt on demand, copying it around is free. */
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FCompactFileList
+{
+	GENERATED_BODY()
+
+	TSharedPtr<CompactPathList, ESPMode::ThreadSafe> Paths;
+};
+
+/* Result of OpenTextFileView, a memory mapped text file whose lines are decoded on demand. */
+USTRUCT(BlueprintType)
+struct FILESYSTEMLIBRARY_API FTextFileView
+{
+	GENERATED_BODY()
+
+	TSharedPtr<MappedTextFile, ESPMode::ThreadSafe> File;
+};
+
 UCLASS()
 class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunctionLibrary
 {
@@ -90,10 +546,10 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "VerifyFile", Keywords = "FileSystemLibrary"), Category = "System File Operations")
 	static bool VerifyFile(FString PathToFile = "")
 	{
-		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		const FFileStatData StatData = FileStatCache::GetStatData(PathToFile);
 
 		// Does the file exist?
-		if (PlatformFile.FileExists(*PathToFile))
+		if (StatData.bIsValid && !StatData.bIsDirectory)
 		{
 			// Success
 			return true;
@@ -111,11 +567,12 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	static bool CopyFile(FString PathToFile, FString DestinationFilePath = "")
 	{
 
-		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-
 		if (VerifyFile(*PathToFile))
 		{
-			if (PlatformFile.CopyFile(*DestinationFilePath, *PathToFile, EPlatformFileRead::AllowWrite, EPlatformFileWrite::AllowRead))
+			const EFileCopyResult Result = FileCopyManager::Get().CopyFile(PathToFile, DestinationFilePath);
+			FileStatCache::Invalidate(DestinationFilePath);
+
+			if (Result == EFileCopyResult::Success)
 			{
 				return true;
 			}
@@ -133,18 +590,23 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	static bool MoveFile(FString PathToFile, FString DestinationFilePath = "")
 	{
 
-		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-
-		if (VerifyFile(*PathToFile))
-		{
-			if (PlatformFile.MoveFile(*DestinationFilePath, *PathToFile))
-			{
-				return true;
-			}
-		}
+		EFileMoveMethod MoveMethod;
+		return MoveFileWithResult(MoveMethod, PathToFile, DestinationFilePath);
+	}
 
-		// Failure
-		return false;
+	/* Same as MoveFile, but also returns how the file was moved. Moves on the same volume are a single rename,
+	moves to another volume copy the file then delete the source.
+	@param	PathToFile				Path to the file to move (including extension).
+	@param	DestinationFilePath		Path to move the file to (including filename and extension).
+	@return	MoveMethod				Rename, CopyAndDelete or Failed.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "MoveFileWithResult", Keywords = "FileSystemLibrary"), Category = "System File Operations")
+	static bool MoveFileWithResult(EFileMoveMethod &MoveMethod, FString PathToFile, FString DestinationFilePath = "")
+	{
+		MoveMethod = ToFileMoveMethod(FileCopyManager::Get().MoveFile(PathToFile, DestinationFilePath));
+		FileStatCache::Invalidate(PathToFile);
+		FileStatCache::Invalidate(DestinationFilePath);
+		return MoveMethod != EFileMoveMethod::Failed;
 	}
 
 	/* This function will rename the specified file. You need to include filename with extension for both input parameters. 
@@ -175,7 +637,10 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 
 		if (VerifyFile(*PathToFile))
 		{
-			if (PlatformFile.DeleteFile(*PathToFile))
+			const bool bDeleted = PlatformFile.DeleteFile(*PathToFile);
+			FileStatCache::Invalidate(PathToFile);
+
+			if (bDeleted)
 			{
 				return true;
 			}
@@ -185,6 +650,60 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 		return false;
 	}
 
+	/* This function will run a list of copy, move and delete operations in parallel. Operations are independent of each other, so don't
+	queue two operations on the same path in one batch.
+	@param	Operations		The operations to execute.
+	@param	MaxConcurrency	Maximum number of operations in flight at once (0 uses every hardware thread).
+	@return	Results			One result per operation, in the same order as Operations.
+	@return	Summary			Success count and timings for the whole batch.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ExecuteFileOperations", Keywords = "FileSystemLibrary batch"), Category = "System File Operations")
+	static bool ExecuteFileOperations(TArray<FFileOperationResult> &Results, FFileOperationBatchSummary &Summary, const TArray<FFileOperation> &Operations, int MaxConcurrency = 0)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		Results.Reset();
+		Results.SetNum(Operations.Num());
+
+		ParallelFileWork::ForEach(Operations.Num(), MaxConcurrency, [&Operations, &Results](int32 Index)
+		{
+			IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+			const FFileOperation& Operation = Operations[Index];
+			const double OperationStartTime = FPlatformTime::Seconds();
+
+			// The platform calls already fail on a missing source, so there is no need to VerifyFile first
+			bool bSucceeded = false;
+			switch (Operation.Operation)
+			{
+			case EFileOperationType::Copy:
+				bSucceeded = FileCopyManager::Get().CopyFile(Operation.PathToFile, Operation.DestinationFilePath) == EFileCopyResult::Success;
+				break;
+			case EFileOperationType::Move:
+				bSucceeded = PlatformFile.MoveFile(*Operation.DestinationFilePath, *Operation.PathToFile);
+				break;
+			case EFileOperationType::Delete:
+				bSucceeded = PlatformFile.DeleteFile(*Operation.PathToFile);
+				break;
+			}
+
+			FileStatCache::Invalidate(Operation.PathToFile);
+			FileStatCache::Invalidate(Operation.DestinationFilePath);
+
+			Results[Index].Succeeded = bSucceeded;
+			Results[Index].DurationSeconds = float(FPlatformTime::Seconds() - OperationStartTime);
+		});
+
+		Summary = FFileOperationBatchSummary();
+		for (const FFileOperationResult& Result : Results)
+		{
+			Result.Succeeded ? Summary.SucceededCount++ : Summary.FailedCount++;
+			Summary.CumulativeSeconds += Result.DurationSeconds;
+		}
+		Summary.TotalSeconds = float(FPlatformTime::Seconds() - StartTime);
+
+		return Summary.FailedCount == 0;
+	}
+
 
 	/***** Directory Operations *****/
 
@@ -198,12 +717,13 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
 
 		// Does the directory exist?
-		if (!PlatformFile.DirectoryExists(*PathToDirectory))
+		if (!VerifyDirectory(PathToDirectory))
 		{
 			if (CreateDirectory)
 			{
 				// If not create directory
 				PlatformFile.CreateDirectoryTree(*PathToDirectory);
+				FileStatCache::InvalidatePathAndParents(PathToDirectory);
 
 				// Check that the directory has been created
 				if (PlatformFile.DirectoryExists(*PathToDirectory))
@@ -226,10 +746,10 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "VerifyDirectory", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
 	static bool VerifyDirectory(const FString &PathToDirectory = "")
 	{
-		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		const FFileStatData StatData = FileStatCache::GetStatData(PathToDirectory);
 
 		// Does the directory exist?
-		if (!PlatformFile.DirectoryExists(*PathToDirectory))
+		if (!StatData.bIsValid || !StatData.bIsDirectory)
 		{
 			// Directory doesn't exist
 			return false;
@@ -248,10 +768,13 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
 
 		// Does the directory exist?
-		if (PlatformFile.DirectoryExists(*PathToDirectory))
+		if (VerifyDirectory(PathToDirectory))
 		{
 			// If it does exist, delete it
-			if (PlatformFile.DeleteDirectoryRecursively(*PathToDirectory))
+			const bool bDeleted = PlatformFile.DeleteDirectoryRecursively(*PathToDirectory);
+			FileStatCache::InvalidateDirectory(PathToDirectory);
+
+			if (bDeleted)
 			{
 				// Success
 				return true;
@@ -262,6 +785,19 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 		return false;
 	}
 
+	/* This function will delete the specified directory and all file/folders inside it without waiting for the deletion.
+	The directory is instantly renamed into a hidden graveyard on the same volume and its content is deleted by a low priority background thread.
+	Graveyards that weren't fully deleted when the application closed are cleaned up the next time the plugin starts.
+	@param PathToDirectory The path to the directory to delete.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "DeleteDirectoryInBackground", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	static bool DeleteDirectoryInBackground(FString PathToDirectory = "")
+	{
+		const bool bBuried = DirectoryGraveyard::Bury(PathToDirectory);
+		FileStatCache::InvalidateDirectory(PathToDirectory);
+		return bBuried;
+	}
+
 	/* This function will copy all files and folders from PathToDirectory to NewPathToDirectory. 
 	@param	PathToDirectory		Path to the directory to copy.
 	@param	NewPathToDirectory	Path to the directory to copy the files to.
@@ -270,24 +806,47 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "CopyDirectory", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
 	static bool CopyDirectory(FString PathToDirectory = "", FString NewPathToDirectory = "", bool AllowOvewrite = true)
 	{
-		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		FDirectoryCopyResult Result;
+		return CopyDirectoryParallel(Result, PathToDirectory, NewPathToDirectory, AllowOvewrite, 0);
+	}
 
-		// Does the directory exist?
-		if (PlatformFile.DirectoryExists(*PathToDirectory))
-		{
-			if (VerifyAndCreateDirectory(NewPathToDirectory, true))
-			{
-				// If it does exist, copy to directory tree
-				if (PlatformFile.CopyDirectoryTree(*NewPathToDirectory, *PathToDirectory, AllowOvewrite))
-				{
-					// Success
-					return true;
-				}
-			}
-		}
+	/* This function will copy all files and folders from PathToDirectory to NewPathToDirectory using several threads at once.
+	Sub-directories are discovered and files are copied in parallel, which is much faster than a single thread on trees with many small files.
+	@param	PathToDirectory		Path to the directory to copy.
+	@param	NewPathToDirectory	Path to the directory to copy the files to.
+	@param	AllowOvewrite		If true, files that already exist in the destination path will be overwritten.
+	@param	MaxConcurrency		Maximum number of threads to use (0 uses every hardware thread).
+	@return	Result				Number of files and bytes copied, with the resulting throughput.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "CopyDirectoryParallel", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	static bool CopyDirectoryParallel(FDirectoryCopyResult &Result, FString PathToDirectory = "", FString NewPathToDirectory = "", bool AllowOvewrite = true, int MaxConcurrency = 0)
+	{
+		FDirectoryCopyStats Stats;
+		const bool bSuccess = FileCopyManager::Get().CopyDirectory(PathToDirectory, NewPathToDirectory, AllowOvewrite, MaxConcurrency, Stats);
+		FileStatCache::InvalidateDirectory(NewPathToDirectory);
 
-		// Failure
-		return false;
+		Result = FDirectoryCopyResult(Stats);
+		return bSuccess;
+	}
+
+	/* This function will make NewPathToDirectory a mirror of PathToDirectory, only copying files that are new or changed.
+	Files with the same size and modification time are skipped, which makes repeated syncs of a mostly unchanged tree very cheap.
+	@param	PathToDirectory		Path to the directory to mirror.
+	@param	NewPathToDirectory	Path to the mirror.
+	@param	DeleteOrphans		If true, files and folders that don't exist in PathToDirectory are deleted from NewPathToDirectory.
+	@param	CompareContent		If true, files of the same size are compared by content hash instead of modification time (slower, reads both files).
+	@param	MaxConcurrency		Maximum number of threads to use (0 uses every hardware thread).
+	@return	Summary				Number of files and bytes copied, skipped and deleted.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "SyncDirectory", Keywords = "FileSystemLibrary mirror"), Category = "System Directory Operations")
+	static bool SyncDirectory(FDirectorySyncSummary &Summary, FString PathToDirectory = "", FString NewPathToDirectory = "", bool DeleteOrphans = false, bool CompareContent = false, int MaxConcurrency = 0)
+	{
+		FDirectorySyncStats Stats;
+		const bool bSuccess = FileCopyManager::Get().SyncDirectory(PathToDirectory, NewPathToDirectory, DeleteOrphans, CompareContent, MaxConcurrency, Stats);
+		FileStatCache::InvalidateDirectory(NewPathToDirectory);
+
+		Summary = FDirectorySyncSummary(Stats);
+		return bSuccess;
 	}
 
 	/* This function will move all files and folders from PathToDirectory to NewPathToDirectory. 
@@ -298,14 +857,24 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "MoveDirectory", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
 	static bool MoveDirectory(FString PathToDirectory = "", FString NewPathToDirectory = "", bool AllowOvewrite = true)
 	{
-		if (CopyDirectory(PathToDirectory, NewPathToDirectory, AllowOvewrite))
-		{
-			if (DeleteDirectory(PathToDirectory))
-			{
-				return true;
-			}
-		}
-		return false;
+		EFileMoveMethod MoveMethod;
+		return MoveDirectoryWithResult(MoveMethod, PathToDirectory, NewPathToDirectory, AllowOvewrite);
+	}
+
+	/* Same as MoveDirectory, but also returns how the directory was moved. If NewPathToDirectory doesn't exist (or is empty) and is on the
+	same volume, the directory is renamed in one go. Otherwise the content is copied and the source is deleted in the background.
+	@param	PathToDirectory		Path to the directory to move.
+	@param	NewPathToDirectory	Path to the directory to move the files to.
+	@param	AllowOvewrite		If true, files that already exist in the destination path will be overwritten.
+	@return	MoveMethod			Rename, CopyAndDelete or Failed.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "MoveDirectoryWithResult", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	static bool MoveDirectoryWithResult(EFileMoveMethod &MoveMethod, FString PathToDirectory = "", FString NewPathToDirectory = "", bool AllowOvewrite = true)
+	{
+		MoveMethod = ToFileMoveMethod(FileCopyManager::Get().MoveDirectory(PathToDirectory, NewPathToDirectory, AllowOvewrite));
+		FileStatCache::InvalidateDirectory(PathToDirectory);
+		FileStatCache::InvalidateDirectory(NewPathToDirectory);
+		return MoveMethod != EFileMoveMethod::Failed;
 	}
 
 	/***** File & Directory Operations *****/
@@ -350,48 +919,162 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetFileOrDirectoryProperties", Keywords = "FileSystemLibrary"), Category = "File System Library")
 	static bool GetFileOrDirectoryProperties(FPathProperties &Properties, FString Path = "")
 	{
-		FFileStatData StatData;
-
-		IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		// A single stat tells us whether the path exists, what it is and its properties
+		const FFileStatData StatData = FileStatCache::GetStatData(Path);
 
-		// Get directory properties
-		if (VerifyDirectory(Path))
+		if (StatData.bIsValid)
 		{
-			StatData = PlatformFile.GetStatData(*Path);
 			Properties = FPathProperties(StatData.CreationTime, StatData.AccessTime, StatData.ModificationTime, StatData.FileSize, StatData.bIsDirectory, StatData.bIsReadOnly);
 			return true;
 		}
 
-		// If not a directory, check file properties
-		else if (VerifyFile(Path))
+		// Failure
+		return false;
+	}
+
+	/* This function will list the directory and the properties of every entry in one pass, instead of a GetFileOrDirectoryProperties call per file.
+	@param	PathToDirectory		Path to the directory to list.
+	@param	Recursive			If true, the entries of all sub-directories are listed as well.
+	@return	Listing				The entries, read them with GetListingNum and GetListingEntry.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ListDirectoryWithProperties", Keywords = "FileSystemLibrary list stat browser"), Category = "File System Library")
+	static bool ListDirectoryWithProperties(FDirectoryListingSnapshot &Listing, FString PathToDirectory, bool Recursive = false)
+	{
+		if (!VerifyDirectory(PathToDirectory))
 		{
-			StatData = PlatformFile.GetStatData(*Path);
-			Properties = FPathProperties(StatData.CreationTime, StatData.AccessTime, StatData.ModificationTime, StatData.FileSize, StatData.bIsDirectory, StatData.bIsReadOnly);
-			return true;
+			return false;
 		}
 
-		// Failure
-		return false;
+		Listing.Listing = DirectoryListing::Create(PathToDirectory, Recursive);
+		return true;
 	}
 
-	/* This function will return the file's or folder's properties. 
-	@param	Path			Path to the file (including extension).
-	@return	FileSizeBytes	The file's size in bytes (multiply by 1 000 000 to get the result in Mb).
+	/* This function will return the number of entries of a listing. */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetListingNum", Keywords = "FileSystemLibrary"), Category = "File System Library")
+	static int GetListingNum(const FDirectoryListingSnapshot& Listing)
+	{
+		return Listing.Listing.IsValid() ? Listing.Listing->Num() : 0;
+	}
+
+	/* This function will return one entry of a listing.
+	@param	Listing		The listing returned by ListDirectoryWithProperties.
+	@param	Index		Index of the entry, between 0 and GetListingNum - 1.
+	@return	Path		Full path of the entry.
+	@return	Properties	The entry's properties.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetListingEntry", Keywords = "FileSystemLibrary"), Category = "File System Library")
+	static bool GetListingEntry(FString &Path, FPathProperties &Properties, const FDirectoryListingSnapshot& Listing, int Index)
+	{
+		if (!Listing.Listing.IsValid() || Index < 0 || Index >= Listing.Listing->Num())
+		{
+			return false;
+		}
+
+		const DirectoryListing& Entries = *Listing.Listing;
+		Path = Entries.GetRootPath() / Entries.GetRelativePath(Index);
+		Properties = FPathProperties(Entries.CreationTimes[Index], Entries.AccessTimes[Index], Entries.ModificationTimes[Index], Entries.Sizes[Index], Entries.IsDirectory(Index), Entries.IsReadOnly(Index));
+		return true;
+	}
+
+	/* This function will return the size of a file, or the total size of everything inside a directory.
+	For a directory the whole tree is walked on every evaluation, use GetDirectorySizeBreakdown with UseCache for repeated queries.
+	@param	Path			Path to the file (including extension) or directory.
+	@return	FileSizeBytes	The size in bytes (divide by 1 000 000 to get the result in MB).
 	*/
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetFileOrDirectorySize", Keywords = "FileSystemLibrary"), Category = "File System Library")
-	static bool GetFileOrDirectorySize(int &FileSizeBytes, FString Path = "")
+	static bool GetFileOrDirectorySize(int64 &FileSizeBytes, FString Path = "")
 	{
 		FPathProperties Properties;
 
 		if (GetFileOrDirectoryProperties(Properties, Path))
 		{
-			FileSizeBytes = (int)Properties.FileSizeBytes;
-			return true;
+			if (!Properties.isDirectory)
+			{
+				FileSizeBytes = Properties.FileSizeBytes;
+				return true;
+			}
+
+			FDirectorySizeStats Total;
+			if (DirectorySizeManager::ComputeSize(Path, 0, false, Total))
+			{
+				FileSizeBytes = Total.SizeBytes;
+				return true;
+			}
 		}
 
 		return false;
 	}
 
+	/* This function will return the total size of a directory and of each of its sub-directories, computed on several threads.
+	Results are cached per directory against its modification time, so asking again is cheap while nothing was added or removed.
+	@param	PathToDirectory		Path to the directory.
+	@param	MaxConcurrency		Maximum number of threads to use (0 uses every hardware thread).
+	@param	UseCache			If false, every directory is listed again (picks up files rewritten in place with a new size).
+	@return	Total				Size and number of files of the whole directory.
+	@return	SubDirectories		Size and number of files of each direct sub-directory, largest first.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "GetDirectorySizeBreakdown", Keywords = "FileSystemLibrary du disk usage"), Category = "File System Library")
+	static bool GetDirectorySizeBreakdown(FDirectorySize &Total, TArray<FDirectorySize> &SubDirectories, FString PathToDirectory, int MaxConcurrency = 0, bool UseCache = true)
+	{
+		FDirectorySizeStats TotalStats;
+		TArray<FDirectorySizeStats> SubDirectoryStats;
+
+		if (!DirectorySizeManager::ComputeSize(PathToDirectory, MaxConcurrency, UseCache, TotalStats, &SubDirectoryStats))
+		{
+			return false;
+		}
+
+		Total = FDirectorySize(TotalStats);
+		SubDirectories.Reset(SubDirectoryStats.Num());
+		for (const FDirectorySizeStats& Stats : SubDirectoryStats)
+		{
+			SubDirectories.Emplace(Stats);
+		}
+		return true;
+	}
+
+	/* This function will turn the path metadata cache on or off. While on, repeated checks on the same path (VerifyFile, VerifyDirectory,
+	GetFileOrDirectoryProperties...) reuse the last result instead of asking the file system again. Changes made through this library
+	invalidate the affected paths; changes made by other programs are seen once the cached entry is older than TimeToLiveSeconds.
+	@param	Enabled				If true, path metadata is cached.
+	@param	TimeToLiveSeconds	How long a cached result stays valid.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "SetPathCacheEnabled", Keywords = "FileSystemLibrary stat cache"), Category = "File System Library")
+	static void SetPathCacheEnabled(bool Enabled = true, float TimeToLiveSeconds = 1.0f)
+	{
+		FileStatCache::SetEnabled(Enabled, TimeToLiveSeconds);
+	}
+
+	/* This function will forget the cached metadata of a path and everything under it. Use it after another program changed the path.
+	@param	Path	Path to the file or directory to forget (leave empty to clear the whole cache).
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "InvalidatePathCache", Keywords = "FileSystemLibrary stat cache"), Category = "File System Library")
+	static void InvalidatePathCache(FString Path = "")
+	{
+		if (Path.IsEmpty())
+		{
+			FileStatCache::Clear();
+		}
+		else
+		{
+			FileStatCache::InvalidateDirectory(Path);
+		}
+	}
+
+	/* This function will return how many path metadata lookups were answered from the cache (hits) and from the file system (misses).
+	@param	ResetCounters	If true, both counters are set back to 0 after being read.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "GetPathCacheCounters", Keywords = "FileSystemLibrary stat cache"), Category = "File System Library")
+	static void GetPathCacheCounters(int64 &Hits, int64 &Misses, bool ResetCounters = false)
+	{
+		FileStatCache::GetCounters(Hits, Misses);
+
+		if (ResetCounters)
+		{
+			FileStatCache::ResetCounters();
+		}
+	}
+
 	/* This function will return the name of all files present in the specified directory. 
 	@param	PathToDirectory			Path to the directory.
 	@param	ExtensionFilter			If set, will only return files of the input extension. (".XXX" or "XXX").
@@ -407,10 +1090,8 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 		if (PlatformFile.DirectoryExists(*PathToDirectory))
 		{
 			TArray<FString> ReturnFiles;
-			FString tempExtensionFilter = ExtensionFilter;
 
-			// Check that the directory has been created
-			PlatformFile.FindFiles(ReturnFiles, *PathToDirectory, *tempExtensionFilter);
+			DirectoryWalkManager::Get().FindFiles(ReturnFiles, PathToDirectory, ExtensionFilter, false);
 
 			// Check if found any files
 			if (ReturnFiles.Num() > 0)
@@ -418,23 +1099,15 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 				// Check if we want to exclude the extension from the return array.
 				if (OnlyReturnFilenames)
 				{
-					TArray<FString> ReturnFilesNoExtension;
-
-					for (int i = 0; i < ReturnFiles.Num(); i++)
+					// Strip in place, no second array
+					for (FString& ReturnFile : ReturnFiles)
 					{
-						ReturnFilesNoExtension.Add(FPaths::GetBaseFilename(ReturnFiles[i]));
+						ReturnFile = FPaths::GetBaseFilename(ReturnFile);
 					}
-
-					Files = ReturnFilesNoExtension;
-					return true;
 				}
 
-				//If not return the array
-				else 
-				{
-					Files = ReturnFiles;
-					return true;
-				}
+				Files = MoveTemp(ReturnFiles);
+				return true;
 			}
 		}
 
@@ -457,10 +1130,9 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 		if (PlatformFile.DirectoryExists(*PathToDirectory))
 		{
 			TArray<FString> ReturnFiles;
-			FString tempExtensionFilter = ExtensionFilter;
 
-			// Check that the directory has been created
-			PlatformFile.FindFilesRecursively(ReturnFiles, *PathToDirectory, *tempExtensionFilter);
+			// Every sub-directory is read by its own task on a thread pool
+			DirectoryWalkManager::Get().FindFiles(ReturnFiles, PathToDirectory, ExtensionFilter, true);
 
 			// Check if found any files
 			if (ReturnFiles.Num() > 0)
@@ -468,53 +1140,271 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 				// Check if we want to exclude the extension from the return array.
 				if (OnlyReturnFilenames)
 				{
-					TArray<FString> ReturnFilesNoExtension;
-
-					for (int i = 0; i < ReturnFiles.Num(); i++)
+					// Strip in place, no second array
+					for (FString& ReturnFile : ReturnFiles)
 					{
-						ReturnFilesNoExtension.Add(FPaths::GetBaseFilename(*ReturnFiles[i]));
+						ReturnFile = FPaths::GetBaseFilename(ReturnFile);
 					}
-
-					Files = ReturnFilesNoExtension;
-					return true;
 				}
 
-				//If not return the array
-				else
-				{
-					Files = ReturnFiles;
-					return true;
-				}
+				Files = MoveTemp(ReturnFiles);
+				return true;
+			}
+		}
+
+		// No files were found
+		return false;
+	}
+
+	/* This function will return the files in the specified directory (and sub-directories) that pass the filter.
+	The filter is applied during the walk: excluded directories are never opened and rejected files cost no allocation.
+	@param	PathToDirectory			Path to the directory.
+	@param	Filter					Include/exclude patterns, directories to skip, size and modification time ranges.
+	@param	Recursive				If true, sub-directories are searched as well.
+	@param	OnlyReturnFilenames		If true, will only return the filenames (without the extension).
+	@return	Files					The files found.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "GetFilesMatchingFilter", Keywords = "FileSystemLibrary glob filter find"), Category = "File System Library")
+	static bool GetFilesMatchingFilter(TArray<FString> &Files, FString PathToDirectory, const FFileFilterSpec& Filter, bool Recursive = true, bool OnlyReturnFilenames = false)
+	{
+		TArray<FString> ReturnFiles;
+		if (!DirectoryWalkManager::Get().FindFiles(ReturnFiles, PathToDirectory, FileFilter(PathToDirectory, Filter.ToRules()), Recursive))
+		{
+			return false;
+		}
+
+		if (OnlyReturnFilenames)
+		{
+			for (FString& ReturnFile : ReturnFiles)
+			{
+				ReturnFile = FPaths::GetBaseFilename(ReturnFile);
+			}
+		}
+
+		Files = MoveTemp(ReturnFiles);
+		return Files.Num() > 0;
+	}
+
+	/* Same as GetFilesMatchingFilter, but the result is kept in a compact form (each directory stored once, names in UTF-8) that takes a
+	fraction of the memory of a string array on large trees. Read it with GetCompactFileListNum and GetCompactFilePath, or convert it with CompactFileListToArray.
+	@param	PathToDirectory			Path to the directory.
+	@param	Filter					Include/exclude patterns, directories to skip, size and modification time ranges.
+	@param	Recursive				If true, sub-directories are searched as well.
+	@return	Files					The files found.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "GetFilesCompact", Keywords = "FileSystemLibrary glob filter find compact"), Category = "File System Library")
+	static bool GetFilesCompact(FCompactFileList &Files, FString PathToDirectory, const FFileFilterSpec& Filter, bool Recursive = true)
+	{
+		TSharedRef<CompactPathList, ESPMode::ThreadSafe> Paths = MakeShared<CompactPathList, ESPMode::ThreadSafe>(PathToDirectory);
+		if (!DirectoryWalkManager::Get().FindFiles(Paths.Get(), PathToDirectory, FileFilter(PathToDirectory, Filter.ToRules()), Recursive))
+		{
+			return false;
+		}
+
+		Files.Paths = Paths;
+		return Paths->Num() > 0;
+	}
+
+	/* This function will return the number of files of a compact file list. */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetCompactFileListNum", Keywords = "FileSystemLibrary"), Category = "File System Library")
+	static int GetCompactFileListNum(const FCompactFileList& Files)
+	{
+		return Files.Paths.IsValid() ? Files.Paths->Num() : 0;
+	}
+
+	/* This function will return the full path of one file of a compact file list, Index goes from 0 to GetCompactFileListNum - 1. */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetCompactFilePath", Keywords = "FileSystemLibrary"), Category = "File System Library")
+	static FString GetCompactFilePath(const FCompactFileList& Files, int Index)
+	{
+		if (!Files.Paths.IsValid() || Index < 0 || Index >= Files.Paths->Num())
+		{
+			return FString();
+		}
+		return Files.Paths->GetPath(Index);
+	}
+
+	/* This function will turn a compact file list into a string array.
+	@param	OnlyReturnFilenames		If true, will only return the filenames (without the extension).
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "CompactFileListToArray", Keywords = "FileSystemLibrary"), Category = "File System Library")
+	static TArray<FString> CompactFileListToArray(const FCompactFileList& Files, bool OnlyReturnFilenames = false)
+	{
+		TArray<FString> Paths;
+		if (!Files.Paths.IsValid())
+		{
+			return Paths;
+		}
+
+		if (OnlyReturnFilenames)
+		{
+			Paths.Reserve(Files.Paths->Num());
+			for (int32 Index = 0; Index < Files.Paths->Num(); Index++)
+			{
+				Paths.Add(FPaths::GetBaseFilename(Files.Paths->GetFileName(Index)));
+			}
+		}
+		else
+		{
+			Files.Paths->ToArray(Paths);
+		}
+		return Paths;
+	}
+
+	/* This function will return one page of the files in the directory, sorted. Only the best Offset + Limit files are kept during the walk,
+	so asking for "the 500 largest files" of a huge tree needs neither a full listing nor a full sort.
+	@param	PathToDirectory		Path to the directory.
+	@param	Filter				Include/exclude patterns, directories to skip, size and modification time ranges.
+	@param	SortBy				What to sort on.
+	@param	Descending			If true, largest/newest/last first.
+	@param	Offset				Number of files to skip, e.g. PageIndex * PageSize.
+	@param	Limit				Number of files to return, e.g. PageSize (0 returns every file after Offset).
+	@param	Recursive			If true, sub-directories are searched as well.
+	@param	MaxConcurrency		Maximum number of threads to use (0 uses every hardware thread).
+	@return	Results				The requested page.
+	@return	TotalMatches		Number of files passing the filter, to compute the number of pages.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "QueryFiles", Keywords = "FileSystemLibrary largest oldest top sort page"), Category = "File System Library")
+	static bool QueryFiles(TArray<FFileQueryResult> &Results, int64 &TotalMatches, FString PathToDirectory, const FFileFilterSpec& Filter, EFileQuerySortKey SortBy = EFileQuerySortKey::Size, bool Descending = true, int Offset = 0, int Limit = 100, bool Recursive = true, int MaxConcurrency = 0)
+	{
+		// The Blueprint enum is passed on as is
+		static_assert(uint8(EFileQuerySortKey::Size) == uint8(EFileSortKey::Size) && uint8(EFileQuerySortKey::ModificationTime) == uint8(EFileSortKey::ModificationTime)
+			&& uint8(EFileQuerySortKey::Name) == uint8(EFileSortKey::Name), "EFileQuerySortKey has to match EFileSortKey");
+
+		TArray<FFileQueryEntry> Entries;
+		if (!FileQueryManager::Query(PathToDirectory, FileFilter(PathToDirectory, Filter.ToRules()), Recursive, EFileSortKey(SortBy), Descending, Offset, Limit, MaxConcurrency, Entries, TotalMatches))
+		{
+			return false;
+		}
+
+		Results.Reset(Entries.Num());
+		for (const FFileQueryEntry& Entry : Entries)
+		{
+			Results.Emplace(Entry);
+		}
+		return true;
+	}
+
+	/* This function will return the directories present at the specified path.
+	@param	Path		Path to the directory to search in.
+	@return	Folders		If true, will only return the filenames (without the extension).
+	*/
+	//UFUNCTION(BlueprintPure, meta = (DisplayName = "GetFoldersInDirectory", Keywords = "FileSystemLibrary"), Category = "File System Library folder")
+		static bool GetFoldersInDirectory(TArray<FString> &Folders, FString Path)
+	{
+			TArray<FString> ReturnFolders;
+
+			// Check that the directory has been created
+			IFileManager::Get().FindFiles(ReturnFolders, *Path, false, true); //This is platform specific and seems to throw an error on Windows.
+
+			// Check if found any files
+			if (ReturnFolders.Num() > 0)
+			{
+				Folders = ReturnFolders;
+				return true;
 			}
+
+		// No files were found
+		return false;
+	}
+
+
+	/***** File Hashing *****/
+
+	/* This function will return the hash of the file's content as a lowercase hex string. The file is streamed, it is never fully loaded in memory.
+	@param	PathToFile	Path to the file to hash (including extension).
+	@param	Algorithm	XxHash3 (fast) or Blake3 (cryptographic).
+	@return	Hash		The hex encoded hash.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "HashFile", Keywords = "FileSystemLibrary hash checksum"), Category = "System File Hashing")
+	static bool HashFile(FString &Hash, FString PathToFile, EFileHashAlgorithm Algorithm = EFileHashAlgorithm::XxHash3)
+	{
+		Hash = FileHashManager::HashFile(PathToFile, ToFileHashType(Algorithm));
+		return !Hash.IsEmpty();
+	}
+
+	/* This function will hash several files in parallel.
+	@param	Files			Paths to the files to hash (including extension).
+	@param	Algorithm		XxHash3 (fast) or Blake3 (cryptographic).
+	@param	MaxConcurrency	Maximum number of threads to use (0 uses every hardware thread).
+	@return	Hashes			One hash per file, in the same order as Files. Files that couldn't be read have an empty hash.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "HashFiles", Keywords = "FileSystemLibrary hash checksum"), Category = "System File Hashing")
+	static bool HashFiles(TArray<FString> &Hashes, const TArray<FString> &Files, EFileHashAlgorithm Algorithm = EFileHashAlgorithm::XxHash3, int MaxConcurrency = 0)
+	{
+		FileHashManager::HashFiles(Files, ToFileHashType(Algorithm), MaxConcurrency, Hashes);
+		return !Hashes.Contains(FString());
+	}
+
+	/* This function will hash every file in the directory and its sub-directories in parallel, and optionally write a manifest file.
+	@param	PathToDirectory		Path to the directory to hash.
+	@param	Algorithm			XxHash3 (fast) or Blake3 (cryptographic).
+	@param	ManifestPath		If set, a manifest listing every file and its hash is written to this path.
+	@param	MaxConcurrency		Maximum number of threads to use (0 uses every hardware thread).
+	@return	Files				Paths of the hashed files, relative to PathToDirectory.
+	@return	Hashes				One hash per file, in the same order as Files.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "HashDirectory", Keywords = "FileSystemLibrary hash checksum manifest"), Category = "System File Hashing")
+	static bool HashDirectory(TArray<FString> &Files, TArray<FString> &Hashes, FString PathToDirectory, EFileHashAlgorithm Algorithm = EFileHashAlgorithm::XxHash3, FString ManifestPath = "", int MaxConcurrency = 0)
+	{
+		const EFileHashType HashType = ToFileHashType(Algorithm);
+
+		if (!FileHashManager::HashDirectory(PathToDirectory, HashType, MaxConcurrency, Files, Hashes))
+		{
+			return false;
+		}
+
+		if (!ManifestPath.IsEmpty())
+		{
+			return FileHashManager::WriteManifest(ManifestPath, HashType, Files, Hashes);
 		}
 
-		// No files were found
-		return false;
+		return true;
+	}
+
+	/* This function will check the files of a directory against a manifest written by HashDirectory.
+	@param	PathToDirectory		Path to the directory to verify.
+	@param	ManifestPath		Path to the manifest file.
+	@param	MaxConcurrency		Maximum number of threads to use (0 uses every hardware thread).
+	@return	ChangedFiles		Files whose content no longer matches the manifest.
+	@return	MissingFiles		Files listed in the manifest that couldn't be read.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "VerifyDirectoryManifest", Keywords = "FileSystemLibrary hash checksum manifest"), Category = "System File Hashing")
+	static bool VerifyDirectoryManifest(TArray<FString> &ChangedFiles, TArray<FString> &MissingFiles, FString PathToDirectory, FString ManifestPath, int MaxConcurrency = 0)
+	{
+		return FileHashManager::VerifyManifest(PathToDirectory, ManifestPath, MaxConcurrency, ChangedFiles, MissingFiles);
 	}
 
-	/* This function will return the directories present at the specified path.
-	@param	Path		Path to the directory to search in.
-	@return	Folders		If true, will only return the filenames (without the extension).
+	/* This function will find files with identical content in the directory and all sub-directories. Files are compared by size first,
+	then by a hash of their beginning and end, and only the remaining candidates are read in full. Empty files are ignored.
+	@param	PathToDirectory		Path to the directory to search in.
+	@param	ExtensionFilter		If set, will only compare files of the input extension. (".XXX" or "XXX").
+	@param	MaxConcurrency		Maximum number of threads to use (0 uses every hardware thread).
+	@return	Duplicates			Groups of identical files, largest files first.
 	*/
-	//UFUNCTION(BlueprintPure, meta = (DisplayName = "GetFoldersInDirectory", Keywords = "FileSystemLibrary"), Category = "File System Library folder")
-		static bool GetFoldersInDirectory(TArray<FString> &Folders, FString Path)
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "FindDuplicateFiles", Keywords = "FileSystemLibrary duplicate dedupe"), Category = "System File Hashing")
+	static bool FindDuplicateFiles(TArray<FDuplicateFileGroup> &Duplicates, FString PathToDirectory, FString ExtensionFilter = "", int MaxConcurrency = 0)
 	{
-			TArray<FString> ReturnFolders;
+		TArray<FString> Files;
+		Duplicates.Reset();
 
-			// Check that the directory has been created
-			IFileManager::Get().FindFiles(ReturnFolders, *Path, false, true); //This is platform specific and seems to throw an error on Windows.
+		if (!GetFilesRecursivelyInDirectory(Files, PathToDirectory, ExtensionFilter, false))
+		{
+			return false;
+		}
 
-			// Check if found any files
-			if (ReturnFolders.Num() > 0)
-			{
-				Folders = ReturnFolders;
-				return true;
-			}
+		TArray<TArray<FString>> Groups;
+		TArray<int64> FileSizes;
+		FileHashManager::FindDuplicateFiles(Files, MaxConcurrency, Groups, FileSizes);
 
-		// No files were found
-		return false;
-	}
+		for (int32 GroupIndex = 0; GroupIndex < Groups.Num(); GroupIndex++)
+		{
+			FDuplicateFileGroup& Group = Duplicates.AddDefaulted_GetRef();
+			Group.Files = MoveTemp(Groups[GroupIndex]);
+			Group.FileSizeBytes = FileSizes[GroupIndex];
+		}
 
+		return Duplicates.Num() > 0;
+	}
 
 	/***** File IO *****/
 
@@ -528,14 +1418,16 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 		// Does the file exist?
 		if (VerifyFile(*PathToFile))
 		{
-			TArray<FString> ReturnFileContent;
-
-			FFileHelper::LoadFileToStringArray(ReturnFileContent, *PathToFile);
+			// Lines are decoded straight from the mapped file, no whole-file UTF-16 copy in between
+			TSharedPtr<MappedTextFile, ESPMode::ThreadSafe> TextFile = MappedTextFile::Open(PathToFile);
 
-			if (ReturnFileContent.Num() > 0)
+			if (TextFile.IsValid() && TextFile->NumLines() > 0)
 			{
+				TArray<FString> ReturnFileContent;
+				TextFile->GetLines(0, TextFile->NumLines(), ReturnFileContent);
+
 				// Success
-				FileContent = ReturnFileContent;
+				FileContent = MoveTemp(ReturnFileContent);
 				return true;
 			}
 		}
@@ -544,27 +1436,68 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 		return false;
 	}
 
-	/* This function will load the content of the specified file to a string. For text file, each array element represents a line from the document.
+	/* This function will open a text file without loading it: the file is memory mapped and only its line positions are read,
+	so even very large files open in milliseconds. Read lines with GetTextFileLineCount, GetTextFileLine and GetTextFileLines.
+	The file stays mapped (and can't be deleted on Windows) until the returned view is no longer referenced.
+	@param	PathToFile		Path to the file to open.
+	@param	UseLineIndex	Keep the line positions in a line index under the Saved directory, reopening the file while it is unchanged then skips reading it.
+	@return	TextFile		The opened file.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "OpenTextFileView", Keywords = "FileSystemLibrary mmap lines"), Category = "SystemFile I/O")
+	static bool OpenTextFileView(FTextFileView &TextFile, FString PathToFile, bool UseLineIndex = false)
+	{
+		TextFile.File = MappedTextFile::Open(PathToFile, UseLineIndex);
+		return TextFile.File.IsValid();
+	}
+
+	/* This function will return the number of lines of an opened text file. */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetTextFileLineCount", Keywords = "FileSystemLibrary"), Category = "SystemFile I/O")
+	static int GetTextFileLineCount(const FTextFileView& TextFile)
+	{
+		return TextFile.File.IsValid() ? TextFile.File->NumLines() : 0;
+	}
+
+	/* This function will return one line of an opened text file, LineIndex starts at 0. */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetTextFileLine", Keywords = "FileSystemLibrary"), Category = "SystemFile I/O")
+	static bool GetTextFileLine(FString &Line, const FTextFileView& TextFile, int LineIndex)
+	{
+		if (!TextFile.File.IsValid() || LineIndex < 0 || LineIndex >= TextFile.File->NumLines())
+		{
+			return false;
+		}
+
+		Line = TextFile.File->GetLine(LineIndex);
+		return true;
+	}
+
+	/* This function will return Count lines of an opened text file, from FirstLine on. */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetTextFileLines", Keywords = "FileSystemLibrary"), Category = "SystemFile I/O")
+	static TArray<FString> GetTextFileLines(const FTextFileView& TextFile, int FirstLine, int Count)
+	{
+		TArray<FString> Lines;
+		if (TextFile.File.IsValid())
+		{
+			TextFile.File->GetLines(FirstLine, Count, Lines);
+		}
+		return Lines;
+	}
+
+	/* This function will insert the input content in the specified file, before the line InsertAtIndex. Only the lines after InsertAtIndex are rewritten.
 	@param	PathToFile		Path to file to edit.
 	@param	FileContent		Content to insert (where one element of the array represent a line of the document).
 	@param	InsertAtIndex	Line number to insert to content at.
+	@param	UseLineIndex	Keep a line index of the file under the Saved directory, so repeated inserts into a large file don't scan it again.
 	*/
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "InsertStringArrayToFile", Keywords = "FileSystemLibrary"), Category = "SystemFile I/O")
-	static bool InsertStringArrayToFile(FString PathToFile, TArray<FString> FileContent, int InsertAtIndex)
+	static bool InsertStringArrayToFile(FString PathToFile, TArray<FString> FileContent, int InsertAtIndex, bool UseLineIndex = false)
 	{
-		TArray<FString> ReturnFileContent;
-
-		if (LoadTextFileToStringArray(ReturnFileContent, PathToFile))
+		// Does the file exist?
+		if (!VerifyFile(*PathToFile))
 		{
-			ReturnFileContent.Insert(FileContent, InsertAtIndex);
-
-			if (SaveStringArrayToFile(PathToFile, ReturnFileContent))
-			{
-				return true;
-			}
+			return false;
 		}
 
-		return false;
+		return FileAppendManager::InsertLines(PathToFile, InsertAtIndex, FileContent, UseLineIndex);
 	}
 
 	/* This function will load the content of the specified file to a string array. For text file, each array element represents a line from the document.
@@ -577,21 +1510,12 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 		// Does the file exist?
 		if (VerifyFile(*PathToFile))
 		{
-			TArray<FString> ReturnFileContent;
-
-			FFileHelper::LoadFileToStringArray(ReturnFileContent, *PathToFile);
+			TSharedPtr<MappedTextFile, ESPMode::ThreadSafe> TextFile = MappedTextFile::Open(PathToFile);
 
-			if (ReturnFileContent.Num() > 0)
+			if (TextFile.IsValid() && TextFile->NumLines() > 0)
 			{
-				FString ReturnString;
-
-				for (int i = 0; i < ReturnFileContent.Num(); i++)
-				{
-					ReturnString = ReturnFileContent[i] + '\n';
-				}
-
-				// Success
-				FileContent = ReturnString;
+				// Every line, each followed by a line break
+				FileContent = TextFile->GetText();
 				return true;
 			}
 		}
@@ -609,23 +1533,16 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	{
 		IFileManager &FileManager = IFileManager::Get();
 
-		TArray<FString> ReturnFileContent;
-		uint32 Flags = 0;
-
-		FFileHelper::SaveStringArrayToFile(FileContent, *PathToFile, FFileHelper::EEncodingOptions::AutoDetect, &FileManager, Flags);
+		// Lines still queued for the old content would otherwise land after the new one
+		FileAppendManager::Flush(PathToFile);
 
-		if (ReturnFileContent.Num() > 0)
-		{
-			// Success
-			FileContent = ReturnFileContent;
-			return true;
-		}
-
-		// No files were found
-		return false;
+		const bool bSaved = FFileHelper::SaveStringArrayToFile(FileContent, *PathToFile, FFileHelper::EEncodingOptions::AutoDetect, &FileManager, 0);
+		FileStatCache::InvalidatePathAndParents(PathToFile);
+		return bSaved;
 	}
 
 	/* This function will append the input string array to the file's content. The AppendFileToStringArray param will insert the input content before the file's. 
+	Appending only writes the new lines, in the encoding of the file, whatever the size of the file. Inserting before the file's content rewrites the file.
 	@param PathToFile				Path to the file to edit.
 	@param FileContent				Content to append to the file.
 	@param AppendFileToStringArray	If true, will insert the input FileContent before the file's content.
@@ -633,28 +1550,49 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "AppendStringArrayToFile", Keywords = "FileSystemLibrary"), Category = "SystemFile I/O")
 	static bool AppendStringArrayToFile(FString PathToFile, TArray<FString> FileContent, bool AppendFileToStringArray)
 	{
-		TArray<FString> ReturnFileContent;
-
-		if (LoadTextFileToStringArray(ReturnFileContent, PathToFile))
+		// Does the file exist?
+		if (!VerifyFile(*PathToFile))
 		{
-			if (AppendFileToStringArray)
-			{
-				TArray<FString> InFileContent = FileContent;
-				InFileContent.Append(ReturnFileContent);
-				ReturnFileContent = InFileContent;
-			}
-			else
-			{
-				ReturnFileContent.Append(FileContent);
-			}
+			return false;
+		}
 
-			if (SaveStringArrayToFile(PathToFile, ReturnFileContent))
-			{
-				return true;
-			}
+		if (AppendFileToStringArray)
+		{
+			return FileAppendManager::PrependLines(PathToFile, FileContent);
 		}
 
-		return false;
+		return FileAppendManager::AppendLines(PathToFile, FileContent);
+	}
+
+	/* This function will queue the input string array to be appended to the file, for files written to very often (e.g. logs).
+	Queued lines are written together once enough of them accumulated or after a short delay (see SetBufferedAppendThresholds),
+	when FlushBufferedAppends is called, and when the game closes. The file is created if it doesn't exist.
+	@param PathToFile				Path to the file to append to.
+	@param FileContent				Lines to append.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "BufferedAppendStringArrayToFile", Keywords = "FileSystemLibrary log queue"), Category = "SystemFile I/O")
+	static void BufferedAppendStringArrayToFile(FString PathToFile, TArray<FString> FileContent)
+	{
+		FileAppendManager::QueueLines(PathToFile, FileContent);
+	}
+
+	/* This function will write the lines queued with BufferedAppendStringArrayToFile right away.
+	@param PathToFile				File to write the queued lines of, leave empty to write the queued lines of every file.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "FlushBufferedAppends", Keywords = "FileSystemLibrary"), Category = "SystemFile I/O")
+	static bool FlushBufferedAppends(FString PathToFile)
+	{
+		return PathToFile.IsEmpty() ? FileAppendManager::FlushAll() : FileAppendManager::Flush(PathToFile);
+	}
+
+	/* This function will set when the lines queued with BufferedAppendStringArrayToFile are written.
+	@param FlushSizeKB				Write the queued lines of a file once they take this much memory.
+	@param FlushIntervalSeconds		Write the queued lines of a file once the oldest has waited this long.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "SetBufferedAppendThresholds", Keywords = "FileSystemLibrary"), Category = "SystemFile I/O")
+	static void SetBufferedAppendThresholds(int FlushSizeKB = 64, float FlushIntervalSeconds = 1.0f)
+	{
+		FileAppendManager::SetFlushThresholds(int64(FMath::Max(FlushSizeKB, 0)) * 1024, FlushIntervalSeconds);
 	}
 
 	/***** Path Utilities *****/
@@ -1087,6 +2025,25 @@ class FILESYSTEMLIBRARY_API UFileSystemLibraryBPLibrary : public UBlueprintFunct
 	{
 		return FPlatformProcess::GetApplicationName(ProcessID);
 	}
+
+private:
+	static EFileHashType ToFileHashType(EFileHashAlgorithm Algorithm)
+	{
+		return Algorithm == EFileHashAlgorithm::Blake3 ? EFileHashType::Blake3 : EFileHashType::XxHash3;
+	}
+
+	static EFileMoveMethod ToFileMoveMethod(EFileMoveResult Result)
+	{
+		switch (Result)
+		{
+		case EFileMoveResult::Renamed:
+			return EFileMoveMethod::Rename;
+		case EFileMoveResult::CopiedAndDeleted:
+			return EFileMoveMethod::CopyAndDelete;
+		default:
+			return EFileMoveMethod::Failed;
+		}
+	}
 };
 
 /***** AsynAction to launch a process and trigger a callback when it finishes. *****/
@@ -1130,3 +2087,355 @@ public:
 	
 	uint32 ProcessID;
 };
+
+/***** AsyncAction to copy a file on a worker thread and report its progress. *****/
+UCLASS(meta = (ExposedAsyncProxy = AsyncAction))
+class UCopyFileAsync : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCopyFileProgress, int64, BytesCopied, int64, TotalBytes);
+	UPROPERTY(BlueprintAssignable)
+	FOnCopyFileProgress Progress;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnCopyFileProgress Completed;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnCopyFileProgress Failed;
+
+	/* Same as CopyFile but the copy runs on a worker thread in large chunks, so the game thread is never blocked.
+	Progress is reported at most once per ProgressInterval. Failed also fires when the copy is cancelled.
+
+		@param	PathToFile				Path to the file to copy (including extension).
+		@param	DestinationFilePath		Path to copy the file to (including filename and extension).
+		@param	ChunkSizeMB				Size of each read/write in megabytes.
+		@param	ProgressInterval		Minimum time in seconds between two Progress events.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", DisplayName = "CopyFileAsync", Keywords = "FileSystemLibrary copy async"), Category = "System File Operations")
+	static UCopyFileAsync* CopyFileAsync(UObject* WorldContextObj, FString PathToFile, FString DestinationFilePath, int ChunkSizeMB = 8, float ProgressInterval = 0.1f);
+
+	/* Stops the copy after the chunk in flight and deletes the partial destination file. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "CancelCopyFile", Keywords = "FileSystemLibrary"), Category = "System File Operations")
+	void Cancel();
+
+	// UBlueprintAsyncActionBase interface
+	virtual void Activate() override;
+	// End of UBlueprintAsyncActionBase interface
+
+	private:
+	void OnCopyFinished(EFileCopyResult Result, int64 BytesCopied, int64 TotalBytes);
+
+
+	FString PathToFile;
+	FString DestinationFilePath;
+	int64 ChunkSize;
+	float ProgressInterval;
+
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> CancelFlag;
+};
+
+// Backpressure shared by the async nodes delivering batches, defined in the .cpp
+struct FAsyncBatchState;
+
+/***** Async node that walks a directory and delivers its files in batches while the walk is still going. *****/
+UCLASS(meta = (ExposedAsyncProxy = AsyncAction))
+class UEnumerateDirectoryAsync : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDirectoryBatch, const TArray<FString>&, Files, int64, FilesFound);
+	UPROPERTY(BlueprintAssignable)
+	FOnDirectoryBatch Batch;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnDirectoryBatch Completed;
+
+	/* Same as GetFilesRecursivelyInDirectory but the walk runs on a worker thread and the files are delivered BatchSize at a time,
+	so memory stays bounded on huge trees and the first files can be processed right away. The walk pauses while MaxBatchesInFlight
+	batches are waiting for the game thread. Completed fires once with an empty array and the total number of files.
+
+		@param	PathToDirectory			Path to the directory to walk.
+		@param	ExtensionFilter			Extension of the files to return (".XXX" or "XXX"), leave empty for all files.
+		@param	OnlyReturnFilenames		Return filenames without path and extension.
+		@param	Recursive				Also walk sub-directories.
+		@param	BatchSize				Number of files per Batch event.
+		@param	MaxBatchesInFlight		Number of batches delivered but not yet broadcast before the walk waits.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", DisplayName = "EnumerateDirectoryAsync", Keywords = "FileSystemLibrary list files async stream"), Category = "System Directory Operations")
+	static UEnumerateDirectoryAsync* EnumerateDirectoryAsync(UObject* WorldContextObj, FString PathToDirectory, FString ExtensionFilter, bool OnlyReturnFilenames, bool Recursive = true, int BatchSize = 1000, int MaxBatchesInFlight = 4);
+
+	/* Stops the walk, no more Batch events are fired. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "CancelEnumerateDirectory", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	void Cancel();
+
+	// UBlueprintAsyncActionBase interface
+	virtual void Activate() override;
+	// End of UBlueprintAsyncActionBase interface
+
+	private:
+	FString PathToDirectory;
+	FString ExtensionFilter;
+	bool bOnlyReturnFilenames;
+	bool bRecursive;
+	int32 BatchSize;
+
+	TSharedPtr<FAsyncBatchState, ESPMode::ThreadSafe> State;
+};
+
+/***** Object that watches a directory and reports its changes in batches on the game thread. *****/
+UCLASS(BlueprintType)
+class FILESYSTEMLIBRARY_API UDirectoryWatcher : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDirectoryChanged, const TArray<FDirectoryChangeEvent>&, Changes);
+	UPROPERTY(BlueprintAssignable)
+	FOnDirectoryChanged OnDirectoryChanged;
+
+	/* Starts watching a directory without polling. Changes are gathered until none happened for DebounceSeconds, merged per path
+	(a file added then modified is reported once as added) and delivered as one array through OnDirectoryChanged.
+	Keep a reference to the returned watcher for as long as you need the events. Only supported on Linux, returns an inactive watcher elsewhere.
+		@param	PathToDirectory		Path to the directory to watch.
+		@param	Recursive			If true, all sub-directories are watched as well.
+		@param	DebounceSeconds		How long the directory has to be quiet before a batch is delivered.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "WatchDirectory", Keywords = "FileSystemLibrary watch monitor inotify"), Category = "System Directory Operations")
+	static UDirectoryWatcher* WatchDirectory(FString PathToDirectory, bool Recursive = true, float DebounceSeconds = 0.2f);
+
+	/* Stops delivering events. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "StopWatchingDirectory", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	void Stop();
+
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "IsWatchingDirectory", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	bool IsWatching() const;
+
+	virtual void BeginDestroy() override;
+
+	private:
+	TUniquePtr<DirectoryWatchManager> WatchManager;
+	bool bIsWatching = false;
+};
+
+/***** Object holding a saved index of a directory tree, so recursive listings don't have to walk the disk again on every start. *****/
+UCLASS(BlueprintType)
+class FILESYSTEMLIBRARY_API UFileIndex : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Loads the index saved at IndexFilePath and refreshes it, or builds it from scratch if there is none (or it was built for another directory).
+	Refreshing only lists directories whose modification time changed, so files added, removed or renamed are picked up, but the size of a file
+	edited in place is only updated by RebuildFileIndex. The index is saved back when anything changed. Returns None if the directory can't be read.
+		@param	PathToDirectory		Path to the directory to index.
+		@param	IndexFilePath		Path to the index file, e.g. in the Saved directory.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "LoadFileIndex", Keywords = "FileSystemLibrary index cache"), Category = "System Directory Operations")
+	static UFileIndex* LoadFileIndex(FString PathToDirectory, FString IndexFilePath);
+
+	/* Brings the index up to date with the disk (see LoadFileIndex) and saves it if anything changed. Returns true if anything changed. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "RefreshFileIndex", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	bool Refresh();
+
+	/* Walks the whole directory again and saves the index. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "RebuildFileIndex", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	bool Rebuild();
+
+	/* Same as GetFilesRecursivelyInDirectory, answered from the index without touching the disk.
+		@param	ExtensionFilter		Extension of the files to return (".XXX" or "XXX"), leave empty for all files.
+	*/
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetIndexedFiles", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	TArray<FString> GetFiles(const FString& ExtensionFilter) const;
+
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetNumIndexedFiles", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	int32 GetNumFiles() const;
+
+	private:
+	PersistentFileIndex Index;
+	FString IndexFilePath;
+};
+
+/***** Object holding the file names of a directory tree in a trigram index, for instant search-as-you-type. *****/
+UCLASS(BlueprintType)
+class FILESYSTEMLIBRARY_API UFileNameIndex : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Walks the directory and indexes the name of every file in it and its sub-directories.
+		@param	PathToDirectory		Path to the directory to index.
+		@param	MaxConcurrency		Maximum number of threads to use for the walk (0 uses every hardware thread).
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "BuildFileNameIndex", Keywords = "FileSystemLibrary search index trigram"), Category = "System Directory Operations")
+	static UFileNameIndex* BuildFileNameIndex(FString PathToDirectory, int MaxConcurrency = 0);
+
+	/* Walks the directory again on a worker thread, searches keep answering from the current content until it is done. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "RebuildFileNameIndexInBackground", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	void RebuildInBackground();
+
+	/* Returns the files whose name contains Query, ignoring case. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "SearchFileNames", Keywords = "FileSystemLibrary search find contains"), Category = "System Directory Operations")
+	TArray<FString> SearchSubstring(const FString& Query, int MaxResults = 100) const;
+
+	/* Returns the files whose name is closest to Query, best match first. Tolerates typos and words in another order. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "SearchFileNamesFuzzy", Keywords = "FileSystemLibrary search find fuzzy"), Category = "System Directory Operations")
+	TArray<FString> SearchFuzzy(const FString& Query, int MaxResults = 100) const;
+
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "AddFileToNameIndex", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	void AddFile(const FString& Path);
+
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "RemoveFileFromNameIndex", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	void RemoveFile(const FString& Path);
+
+	/* Keeps the index up to date from the events of a directory watcher (bind it to OnDirectoryChanged). */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "ApplyDirectoryChangesToNameIndex", Keywords = "FileSystemLibrary watch"), Category = "System Directory Operations")
+	void ApplyDirectoryChanges(const TArray<FDirectoryChangeEvent>& Changes);
+
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "GetNumFileNamesIndexed", Keywords = "FileSystemLibrary"), Category = "System Directory Operations")
+	int32 GetNumFiles() const;
+
+	TSharedPtr<FileNameIndex, ESPMode::ThreadSafe> GetIndex() const { return Index; }
+
+	private:
+	// Created with the object, so one made with Construct Object from Class is an empty index rather than a null one
+	TSharedPtr<FileNameIndex, ESPMode::ThreadSafe> Index = MakeShared<FileNameIndex, ESPMode::ThreadSafe>();
+	int32 MaxConcurrency = 0;
+};
+
+/***** Async node that searches a file name index on a worker thread. *****/
+UCLASS()
+class USearchFileNameIndexAsync : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnFileNameSearchCompleted, const TArray<FString>&, Results);
+	UPROPERTY(BlueprintAssignable)
+	FOnFileNameSearchCompleted Completed;
+
+	/* Same as SearchFileNames / SearchFileNamesFuzzy, without blocking the game thread.
+		@param	Index			The index to search.
+		@param	Query			Part of the file name to look for.
+		@param	Fuzzy			If true, returns the closest names instead of the names containing Query.
+		@param	MaxResults		Maximum number of files to return.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", DisplayName = "SearchFileNameIndexAsync", Keywords = "FileSystemLibrary search async"), Category = "System Directory Operations")
+	static USearchFileNameIndexAsync* SearchFileNameIndexAsync(UObject* WorldContextObj, UFileNameIndex* Index, FString Query, bool Fuzzy = false, int MaxResults = 100);
+
+	// UBlueprintAsyncActionBase interface
+	virtual void Activate() override;
+	// End of UBlueprintAsyncActionBase interface
+
+	private:
+	TSharedPtr<FileNameIndex, ESPMode::ThreadSafe> Index;
+	FString Query;
+	bool bFuzzy;
+	int32 MaxResults;
+};
+
+/***** Async node that searches the content of every file of a directory tree and reports the hits while the search runs. *****/
+UCLASS(meta = (ExposedAsyncProxy = AsyncAction))
+class UFindInFilesAsync : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnFindInFilesHits, const TArray<FContentSearchHit>&, Hits, int64, TotalHits);
+	UPROPERTY(BlueprintAssignable)
+	FOnFindInFilesHits Found;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnFindInFilesHits Completed;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnFindInFilesHits Failed;
+
+	/* Searches the content of the files in the directory and all sub-directories for Pattern. Files are memory mapped and searched
+	on several threads, hits are delivered through Found in batches (at most once per ReportInterval) while the search runs.
+	Completed fires once with an empty array and the total number of hits. Binary files are skipped.
+	Failed fires instead if the directory can't be read, or if Pattern is empty or not a valid regular expression.
+		@param	PathToDirectory		Path to the directory to search in.
+		@param	Pattern				Text to look for, or a regular expression when Regex is set.
+		@param	Filter				Which files to search (e.g. Include "*.ini", "*.log").
+		@param	Regex				If true, Pattern is an ICU regular expression.
+		@param	CaseSensitive		If false, case is ignored (ASCII letters only for plain text patterns).
+		@param	MaxHitsPerFile		Stop looking in a file after this many hits, 0 for no limit.
+		@param	MaxConcurrency		Maximum number of threads to use (0 uses every hardware thread).
+		@param	ReportInterval		Minimum time in seconds between two Found events.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", DisplayName = "FindInFilesAsync", Keywords = "FileSystemLibrary grep search content async"), Category = "SystemFile I/O")
+	static UFindInFilesAsync* FindInFilesAsync(UObject* WorldContextObj, FString PathToDirectory, FString Pattern, const FFileFilterSpec& Filter, bool Regex = false, bool CaseSensitive = true, int MaxHitsPerFile = 0, int MaxConcurrency = 0, float ReportInterval = 0.1f);
+
+	/* Stops the search, no more events are fired. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "CancelFindInFiles", Keywords = "FileSystemLibrary"), Category = "SystemFile I/O")
+	void Cancel();
+
+	// UBlueprintAsyncActionBase interface
+	virtual void Activate() override;
+	// End of UBlueprintAsyncActionBase interface
+
+	private:
+	FString PathToDirectory;
+	FString Pattern;
+	FFileFilterSpec Filter;
+	FContentSearchOptions Options;
+	int32 MaxConcurrency;
+	float ReportInterval;
+
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> CancelFlag;
+};
+
+/***** Async node that reads a text file on a worker thread and delivers its lines in batches. *****/
+UCLASS(meta = (ExposedAsyncProxy = AsyncAction))
+class UReadLinesAsync : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnLinesBatch, const TArray<FString>&, Lines, int64, LinesRead);
+	UPROPERTY(BlueprintAssignable)
+	FOnLinesBatch Batch;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnLinesBatch Completed;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnLinesBatch Failed;
+
+	/* Same as LoadTextFileToStringArray but the file is read in chunks on a worker thread and the lines are delivered BatchSize at a time,
+	so files of any size (logs, CSV exports) can be processed while only a few MB are held in memory. Reading pauses while MaxBatchesInFlight
+	batches are waiting for the game thread. Completed fires once with an empty array and the total number of lines.
+	Failed fires if the file can't be opened, or if reading fails partway, with the number of lines delivered until then. UTF-8 and ANSI files only.
+
+		@param	PathToFile				Path to the text file to read.
+		@param	BatchSize				Number of lines per Batch event.
+		@param	MaxBatchesInFlight		Number of batches delivered but not yet broadcast before reading waits.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", DisplayName = "ReadLinesAsync", Keywords = "FileSystemLibrary text file lines async stream"), Category = "SystemFile I/O")
+	static UReadLinesAsync* ReadLinesAsync(UObject* WorldContextObj, FString PathToFile, int BatchSize = 1000, int MaxBatchesInFlight = 4);
+
+	/* Stops reading, no more Batch events are fired. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "CancelReadLines", Keywords = "FileSystemLibrary"), Category = "SystemFile I/O")
+	void Cancel();
+
+	// UBlueprintAsyncActionBase interface
+	virtual void Activate() override;
+	// End of UBlueprintAsyncActionBase interface
+
+	private:
+	FString PathToFile;
+	int32 BatchSize;
+
+	TSharedPtr<FAsyncBatchState, ESPMode::ThreadSafe> State;
+};
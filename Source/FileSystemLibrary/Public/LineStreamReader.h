@@ -0,0 +1,49 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for reading a text file line by line in large chunks, so files of any size can be processed
+// with a memory footprint of one chunk plus the longest line. Reads UTF-8 and ANSI files (a UTF-8 BOM is skipped).
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+class IFileHandle;
+
+class FILESYSTEMLIBRARY_API LineStreamReader
+{
+
+public:
+	static const int64 DefaultChunkSize = 4 * 1024 * 1024;
+
+	LineStreamReader();
+	~LineStreamReader();
+
+	bool Open(const FString& PathToFile, int64 ChunkSize = DefaultChunkSize);
+
+	/** Replaces the content of OutLines with the next (at most MaxLines) lines, line breaks removed.
+	 * Returns false once the end of the file is reached and no line was left.
+	 */
+	bool ReadLines(TArray<FString>& OutLines, int32 MaxLines);
+
+	/** Whether reading stopped because the file couldn't be read, rather than at its end. The lines returned so far are still valid. */
+	bool HasReadError() const { return bReadError; }
+
+	int64 GetFileSize() const { return FileSize; }
+	int64 GetBytesRead() const { return BytesRead; }
+
+private:
+	/** Moves the unconsumed bytes to the front of the buffer and reads the next chunk after them. Returns false at the end of the file. */
+	bool ReadChunk();
+
+	TUniquePtr<IFileHandle> Handle;
+	int64 ChunkSize = DefaultChunkSize;
+	int64 FileSize = 0;
+	int64 BytesRead = 0;
+
+	TArray<uint8> Buffer;
+	// Bytes before this offset have already been returned as lines
+	int32 Consumed = 0;
+	bool bEndOfFile = false;
+	bool bReadError = false;
+};
@@ -0,0 +1,19 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for reading directories on the Linux platform straight from the kernel.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DirectoryWalkManager.h"
+
+
+
+class FILESYSTEMLIBRARY_API DirectoryWalkManagerLinux : public DirectoryWalkManager
+{
+public:
+	/** Reads entries with getdents64 into a large per-thread buffer, so a directory takes a handful of syscalls,
+	 * and uses d_type to tell files from directories without a stat (only symlinks and file systems reporting DT_UNKNOWN are stat'ed).
+	 */
+	virtual bool ReadDirectory(const FString& PathToDirectory, FEntryVisitor Visitor) override;
+};
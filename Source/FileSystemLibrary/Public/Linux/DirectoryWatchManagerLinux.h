@@ -0,0 +1,75 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for watching directories on the Linux platform with inotify.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DirectoryWatchManager.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FRunnableThread;
+
+
+
+class FILESYSTEMLIBRARY_API DirectoryWatchManagerLinux : public DirectoryWatchManager, public FRunnable
+{
+public:
+	virtual ~DirectoryWatchManagerLinux();
+
+	virtual bool StartWatching(const FString& PathToDirectory, bool bRecursive, double DebounceSeconds, FChangesCallback OnChanges) override;
+	virtual void StopWatching() override;
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	// End of FRunnable interface
+
+private:
+	/** Watches Directory (and its sub-directories when recursive). With bReportContents, files already inside are reported as added,
+	 * they may have been created before the watch existed.
+	 */
+	void AddWatch(const FString& Directory, bool bReportContents);
+	void RemoveWatches(const FString& Directory);
+	void RenameWatches(const FString& OldDirectory, const FString& NewDirectory);
+
+	void ReadEvents();
+	void RecordChange(const FString& Path, EDirectoryChangeType Type, const FString& OldPath = FString());
+	void Flush();
+
+	int InotifyFd = -1;
+	int WakeFd = -1;
+
+	FString RootPath;
+	bool bWatchRecursively = false;
+	double Debounce = 0.0;
+	FChangesCallback ChangesCallback;
+
+	TMap<int32, FString> WatchedDirectories;
+
+	// Linux file systems are case sensitive, FString keys are not by default
+	struct FCaseSensitivePathKeyFuncs : TDefaultMapKeyFuncs<FString, FDirectoryChange, false>
+	{
+		static bool Matches(const FString& A, const FString& B)
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+
+		static uint32 GetKeyHash(const FString& Key)
+		{
+			return FCrc::StrCrc32(*Key);
+		}
+	};
+
+	// Changes of the current burst, keyed by path
+	TMap<FString, FDirectoryChange, FDefaultSetAllocator, FCaseSensitivePathKeyFuncs> PendingChanges;
+
+	// IN_MOVED_FROM halves waiting for their IN_MOVED_TO, keyed by inotify cookie
+	TMap<uint32, TPair<FString, bool>> PendingMoves;
+
+	double FirstPendingTime = 0.0;
+	double LastEventTime = 0.0;
+
+	FRunnableThread* Thread = nullptr;
+	std::atomic<bool> bStopping{ false };
+};
@@ -0,0 +1,17 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for copying files on the Linux platform without bouncing the data through user-space buffers.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FileCopyManager.h"
+
+
+
+class FILESYSTEMLIBRARY_API FileCopyManagerLinux : public FileCopyManager
+{
+public:
+	/** Tries, in order: a reflink clone (FICLONE, instant on Btrfs/XFS), copy_file_range, sendfile, then the buffered copy of FileCopyManager. */
+	virtual EFileCopyResult CopyFile(const FString& PathToFile, const FString& DestinationFilePath, const FThreadSafeBool* CancelFlag = nullptr, const FProgressCallback& OnProgress = FProgressCallback(), int64 ChunkSize = DefaultChunkSize) override;
+};
@@ -0,0 +1,88 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for opening text files without loading them: the file is memory mapped, line boundaries are found with
+// memchr, and a line is only decoded to an FString when it is asked for. Handles UTF-8 (with or without BOM), ANSI and UTF-16 with a BOM.
+// The line positions can be kept in a line index file, so reopening a file that didn't change skips the scan.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+class FILESYSTEMLIBRARY_API MappedTextFile
+{
+
+public:
+	/** Position of a line in the file, in bytes, line break excluded. */
+	struct FLineView
+	{
+		int64 Offset;
+		int64 Length;
+	};
+
+	/** Maps the file and indexes its lines. Returns null if the file can't be mapped. An empty file has no lines.
+	 * With bUseLineIndex the line positions are read from the file's line index when its size and modification time still match,
+	 * otherwise the lines are scanned and the line index is saved for next time.
+	 */
+	static TSharedPtr<MappedTextFile, ESPMode::ThreadSafe> Open(const FString& PathToFile, bool bUseLineIndex = false);
+
+	/** Saves the line positions of PathToFile, stamped with the file's current size and modification time. */
+	static bool SaveLineIndex(const FString& PathToFile, const TArray<int64>& LineStarts);
+
+	/** Where the line index of PathToFile is kept, under the project's Saved directory. */
+	static FString GetLineIndexPath(const FString& PathToFile);
+
+	/** Deletes the line indexes whose file changed or no longer exists, called when the module starts. */
+	static void PurgeStaleLineIndexes();
+
+	~MappedTextFile();
+
+	int32 NumLines() const { return LineStarts.Num(); }
+
+	FLineView GetLineView(int32 Index) const;
+
+	/** Decodes a single line. */
+	FString GetLine(int32 Index) const;
+
+	/** Decodes Count lines from First on (clamped to the file) and appends them to OutLines. */
+	void GetLines(int32 First, int32 Count, TArray<FString>& OutLines) const;
+
+	/** Decodes the whole file, every line followed by '\n' (CRLF line breaks become LF). */
+	FString GetText() const;
+
+	/** Byte offset of the start of each line. */
+	const TArray<int64>& GetLineStarts() const { return LineStarts; }
+
+	/** The raw mapped bytes, BOM included. */
+	const uint8* GetData() const { return Data; }
+	int64 GetSize() const { return Size; }
+
+private:
+	enum class EEncoding : uint8
+	{
+		// UTF-8 and ANSI files, ANSI being treated as UTF-8
+		Utf8,
+		Utf16LittleEndian,
+		Utf16BigEndian
+	};
+
+	MappedTextFile() = default;
+
+	void IndexLines();
+	bool LoadLineIndex(const FString& PathToFile);
+	FString Decode(const FLineView& View) const;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> Region;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	EEncoding Encoding = EEncoding::Utf8;
+	// First byte after the BOM
+	int64 TextStart = 0;
+
+	// Byte offset of the start of each line, a line ends where the next one starts (minus its line break)
+	TArray<int64> LineStarts;
+};
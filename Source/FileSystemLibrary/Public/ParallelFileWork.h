@@ -0,0 +1,70 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for spreading file system work over a bounded number of worker threads.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Templates/UniquePtr.h"
+#include <atomic>
+
+class FILESYSTEMLIBRARY_API ParallelFileWork
+{
+
+public:
+	/** Number of workers used when the caller passes a concurrency of 0 or less. */
+	static int32 GetDefaultConcurrency();
+
+	/** Runs Body for every index in [0, Num) on at most MaxConcurrency threads (the calling thread included) and returns once all of them are done.
+	 * The other threads come from a dedicated below normal priority pool, so blocking file I/O never occupies the engine's task graph.
+	 * With bBackgroundPriority they come from a second pool at the lowest priority instead.
+	 */
+	static void ForEach(int32 Num, int32 MaxConcurrency, TFunctionRef<void(int32 Index)> Body, bool bBackgroundPriority = false);
+
+	/** Destroys the thread pools ForEach and FileTaskScheduler run on, called when the module shuts down. */
+	static void Shutdown();
+};
+
+/** Runs tasks that can spawn more tasks (e.g. one task per directory discovering one task per file) on a fixed set of workers.
+ * The workers are the calling thread plus threads of the same dedicated pool as ParallelFileWork::ForEach. Every worker owns a deque:
+ * it pushes and pops its own work at the back (depth first, keeps the working set small) and steals from the front of the other deques
+ * when it runs dry (oldest work first, which tends to be the biggest subtrees).
+ */
+class FILESYSTEMLIBRARY_API FileTaskScheduler
+{
+
+public:
+	typedef TFunction<void(FileTaskScheduler& Scheduler, int32 WorkerIndex)> FTask;
+
+	/** MaxConcurrency of 0 or less uses ParallelFileWork::GetDefaultConcurrency(). */
+	explicit FileTaskScheduler(int32 MaxConcurrency);
+	~FileTaskScheduler();
+
+	/** Queues a task on the deque of WorkerIndex. Call with 0 before Run(), or with the index a running task was given. */
+	void Spawn(int32 WorkerIndex, FTask&& Task);
+
+	/** Executes every queued task, and every task they spawn, then returns. */
+	void Run();
+
+	int32 GetNumWorkers() const { return Queues.Num(); }
+
+private:
+	struct FWorkerQueue
+	{
+		FCriticalSection Lock;
+		TArray<FTask> Tasks;
+	};
+
+	bool PopOrSteal(int32 WorkerIndex, FTask& OutTask);
+	void WorkerLoop(int32 WorkerIndex);
+
+	TArray<TUniquePtr<FWorkerQueue>> Queues;
+
+	// Queued plus running tasks, a task is only retired after everything it spawned has been queued
+	std::atomic<int32> PendingTasks;
+
+	// Idle workers sleep on WorkAvailable, the generation tells them whether a task was spawned since they last looked
+	FEvent* WorkAvailable;
+	std::atomic<uint32> WorkGeneration;
+};
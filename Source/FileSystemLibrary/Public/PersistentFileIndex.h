@@ -0,0 +1,64 @@
+// Copyright Lambda Works, Samuel Metters 2019. All rights reserved.
+
+// This class is responsible for keeping a compact index of a directory tree (paths, sizes and modification times) that can be
+// saved to a binary file, loaded back through a memory mapping and refreshed by only re-listing directories that changed.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FILESYSTEMLIBRARY_API PersistentFileIndex
+{
+
+public:
+	/** Walks RootPath and replaces the content of the index. */
+	bool Build(const FString& RootPath);
+
+	/** Re-stats every indexed directory and only lists again those whose modification time changed (or that are new).
+	 * A directory's modification time changes when entries are added, removed or renamed in it, not when a file is edited in place:
+	 * sizes and times of files in unchanged directories are kept as they were. Returns true if anything changed.
+	 */
+	bool Refresh();
+
+	bool Save(const FString& IndexFilePath) const;
+	bool Load(const FString& IndexFilePath);
+
+	/** Appends the full path of every indexed file matching ExtensionFilter (".XXX" or "XXX", empty for all) to OutFiles. */
+	void GetFiles(TArray<FString>& OutFiles, const FString& ExtensionFilter = FString()) const;
+
+	const FString& GetRootPath() const { return RootPath; }
+	int32 GetNumFiles() const { return Files.Num(); }
+	int32 GetNumDirectories() const { return Directories.Num(); }
+
+private:
+	// Plain data, written to and read from disk as is
+	struct FIndexedDirectory
+	{
+		uint32 PathOffset;
+		uint32 PathLength;
+		int64 ModificationTicks;
+		uint32 FirstFile;
+		uint32 NumFiles;
+	};
+
+	struct FIndexedFile
+	{
+		uint32 NameOffset;
+		uint32 NameLength;
+		int64 Size;
+		int64 ModificationTicks;
+	};
+
+	/** Appends a UTF-8 string to Strings and returns its offset. */
+	uint32 AddString(const FString& String, uint32& OutLength);
+	FString GetString(uint32 Offset, uint32 Length) const;
+
+	/** Adds a directory and its files from a fresh listing, returns its sub-directories (relative). */
+	void ListDirectory(const FString& RelativePath, int64 ModificationTicks, TArray<TPair<FString, int64>>& OutSubDirectories);
+
+	FString RootPath;
+	TArray<FIndexedDirectory> Directories;
+	TArray<FIndexedFile> Files;
+	// UTF-8 directory paths (relative to RootPath) and file names
+	TArray<ANSICHAR> Strings;
+};